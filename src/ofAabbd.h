@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <cfloat>
+
+/// \brief ofAabbd is an axis aligned bounding box in double precision.
+///
+/// A default constructed box is empty: adding the first point makes it a
+/// box of size zero around that point.
+///
+/// ~~~~{.cpp}
+/// ofAabbd box;
+/// for( size_t i = 0; i < points.size(); i++ ) {
+///     box.add(points[i]);
+/// }
+/// ofVec3d center = box.getCenter();
+/// ~~~~
+class ofAabbd {
+public:
+	/// \brief Stores the corner with the smallest coordinates.
+	ofVec3d min;
+
+	/// \brief Stores the corner with the largest coordinates.
+	ofVec3d max;
+
+	/// \brief Constructs an empty box.
+	ofAabbd();
+	ofAabbd( const ofVec3d& min, const ofVec3d& max );
+
+	/// \brief Returns true if nothing was added to the box.
+	bool isEmpty() const;
+
+	ofVec3d getCenter() const;
+
+	/// \brief Returns the size of the box on every axis.
+	ofVec3d getSize() const;
+
+	/// \brief Returns half the size of the box on every axis.
+	ofVec3d getExtents() const;
+
+	double getSurfaceArea() const;
+
+	/// \brief Grows the box to include 'p'.
+	void add( const ofVec3d& p );
+
+	/// \brief Grows the box to include 'box'.
+	void add( const ofAabbd& box );
+
+	/// \brief Returns the smallest box containing this box and 'box'.
+	ofAabbd getMerged( const ofAabbd& box ) const;
+
+	/// \brief Returns a copy of this box grown by 'margin' on every side.
+	ofAabbd getExpanded( double margin ) const;
+
+	bool contains( const ofVec3d& p ) const;
+	bool contains( const ofAabbd& box ) const;
+
+	/// \brief Returns true if the boxes overlap or touch.
+	bool intersects( const ofAabbd& box ) const;
+};
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofAabbd::ofAabbd()
+:min(DBL_MAX, DBL_MAX, DBL_MAX)
+,max(-DBL_MAX, -DBL_MAX, -DBL_MAX) {}
+
+inline ofAabbd::ofAabbd( const ofVec3d& _min, const ofVec3d& _max )
+:min(_min)
+,max(_max) {}
+
+inline bool ofAabbd::isEmpty() const {
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+inline ofVec3d ofAabbd::getCenter() const {
+	return ofVec3d( (min.x+max.x)*0.5, (min.y+max.y)*0.5, (min.z+max.z)*0.5 );
+}
+
+inline ofVec3d ofAabbd::getSize() const {
+	return max - min;
+}
+
+inline ofVec3d ofAabbd::getExtents() const {
+	return (max - min) * 0.5;
+}
+
+inline double ofAabbd::getSurfaceArea() const {
+	ofVec3d d = max - min;
+	return 2.0 * (d.x*d.y + d.y*d.z + d.z*d.x);
+}
+
+inline void ofAabbd::add( const ofVec3d& p ) {
+	min.x = MIN( min.x, p.x ); max.x = MAX( max.x, p.x );
+	min.y = MIN( min.y, p.y ); max.y = MAX( max.y, p.y );
+	min.z = MIN( min.z, p.z ); max.z = MAX( max.z, p.z );
+}
+
+inline void ofAabbd::add( const ofAabbd& box ) {
+	min.x = MIN( min.x, box.min.x ); max.x = MAX( max.x, box.max.x );
+	min.y = MIN( min.y, box.min.y ); max.y = MAX( max.y, box.max.y );
+	min.z = MIN( min.z, box.min.z ); max.z = MAX( max.z, box.max.z );
+}
+
+inline ofAabbd ofAabbd::getMerged( const ofAabbd& box ) const {
+	ofAabbd merged( *this );
+	merged.add( box );
+	return merged;
+}
+
+inline ofAabbd ofAabbd::getExpanded( double margin ) const {
+	return ofAabbd( min - margin, max + margin );
+}
+
+inline bool ofAabbd::contains( const ofVec3d& p ) const {
+	return p.x >= min.x && p.x <= max.x
+	&& p.y >= min.y && p.y <= max.y
+	&& p.z >= min.z && p.z <= max.z;
+}
+
+inline bool ofAabbd::contains( const ofAabbd& box ) const {
+	return box.min.x >= min.x && box.max.x <= max.x
+	&& box.min.y >= min.y && box.max.y <= max.y
+	&& box.min.z >= min.z && box.max.z <= max.z;
+}
+
+inline bool ofAabbd::intersects( const ofAabbd& box ) const {
+	return min.x <= box.max.x && max.x >= box.min.x
+	&& min.y <= box.max.y && max.y >= box.min.y
+	&& min.z <= box.max.z && max.z >= box.min.z;
+}
@@ -0,0 +1,356 @@
+#include "ofBarnesHutd.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace {
+
+// bits per axis of the Morton codes, which is also the deepest level of the octree
+const int MORTON_BITS = 21;
+
+// level at which the octree is split into subtrees built in parallel (up to 64 of them)
+const int PARALLEL_LEVEL = 2;
+
+// smallest number of bodies worth a thread
+const size_t BH_MIN_CHUNK = 4096;
+
+// spreads the lowest 21 bits of 'v' so that there are two zero bits between each of them
+inline unsigned long long spreadBits( unsigned long long v ) {
+	v &= 0x1fffffULL;
+	v = (v | v << 32) & 0x1f00000000ffffULL;
+	v = (v | v << 16) & 0x1f0000ff0000ffULL;
+	v = (v | v << 8) & 0x100f00f00f00f00fULL;
+	v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+	v = (v | v << 2) & 0x1249249249249249ULL;
+	return v;
+}
+
+inline int getOctant( unsigned long long code, int level ) {
+	return (int)((code >> (3 * (MORTON_BITS - 1 - level))) & 7);
+}
+
+}
+
+
+ofBarnesHutd::ofBarnesHutd()
+:theta(0.5)
+,softening(0.0)
+,G(1.0)
+,leafSize(16) {}
+
+void ofBarnesHutd::setTheta( double _theta ) {
+	theta = _theta;
+}
+
+double ofBarnesHutd::getTheta() const {
+	return theta;
+}
+
+void ofBarnesHutd::setSoftening( double _softening ) {
+	softening = _softening;
+}
+
+double ofBarnesHutd::getSoftening() const {
+	return softening;
+}
+
+void ofBarnesHutd::setGravitationalConstant( double _G ) {
+	G = _G;
+}
+
+double ofBarnesHutd::getGravitationalConstant() const {
+	return G;
+}
+
+void ofBarnesHutd::setLeafSize( size_t _leafSize ) {
+	leafSize = _leafSize > 0 ? _leafSize : 1;
+}
+
+
+// Tree construction.
+//
+//
+void ofBarnesHutd::build( const ofVec3d* positions, const double* masses, size_t num ) {
+	nodes.clear();
+	bx.clear(); by.clear(); bz.clear(); bm.clear();
+	codes.clear();
+	order.clear();
+	if( positions == NULL || num == 0 ) {
+		return;
+	}
+
+	// bounding cube
+	size_t numChunks = ofGetParallelNumChunks( num, BH_MIN_CHUNK );
+	std::vector<ofVec3d> chunkMin( numChunks, ofVec3d( DBL_MAX ) ), chunkMax( numChunks, ofVec3d( -DBL_MAX ) );
+	ofParallelForChunks( num, BH_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		ofVec3d& lo = chunkMin[chunk];
+		ofVec3d& hi = chunkMax[chunk];
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d& p = positions[i];
+			lo.x = MIN( lo.x, p.x ); hi.x = MAX( hi.x, p.x );
+			lo.y = MIN( lo.y, p.y ); hi.y = MAX( hi.y, p.y );
+			lo.z = MIN( lo.z, p.z ); hi.z = MAX( hi.z, p.z );
+		}
+	});
+	ofVec3d lo = chunkMin[0], hi = chunkMax[0];
+	for( size_t c=1; c<numChunks; c++ ) {
+		lo.x = MIN( lo.x, chunkMin[c].x ); hi.x = MAX( hi.x, chunkMax[c].x );
+		lo.y = MIN( lo.y, chunkMin[c].y ); hi.y = MAX( hi.y, chunkMax[c].y );
+		lo.z = MIN( lo.z, chunkMin[c].z ); hi.z = MAX( hi.z, chunkMax[c].z );
+	}
+	double rootSize = MAX( hi.x - lo.x, MAX( hi.y - lo.y, hi.z - lo.z ) );
+	if( rootSize <= 0 ) {
+		rootSize = 1.0;
+	}
+
+	// Morton codes, then sort the bodies along the curve
+	const double cells = (double)(1 << MORTON_BITS);
+	const double scale = cells / rootSize;
+	std::vector< std::pair<unsigned long long, unsigned int> > keyed( num );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d& p = positions[i];
+			double qx = MIN( (p.x - lo.x) * scale, cells - 1 );
+			double qy = MIN( (p.y - lo.y) * scale, cells - 1 );
+			double qz = MIN( (p.z - lo.z) * scale, cells - 1 );
+			unsigned long long code = spreadBits( (unsigned long long)qx ) << 2
+			| spreadBits( (unsigned long long)qy ) << 1
+			| spreadBits( (unsigned long long)qz );
+			keyed[i] = std::make_pair( code, (unsigned int)i );
+		}
+	}, BH_MIN_CHUNK );
+
+	// sorted runs in parallel, then merged; the pairs are unique so the order
+	// does not depend on the number of threads
+	std::vector<size_t> runs( numChunks + 1, num );
+	ofParallelForChunks( num, BH_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::sort( keyed.begin() + begin, keyed.begin() + end );
+		runs[chunk] = begin;
+	});
+	for( size_t width=1; width<numChunks; width*=2 ) {
+		for( size_t c=0; c + width < numChunks; c += 2*width ) {
+			size_t last = MIN( c + 2*width, numChunks );
+			std::inplace_merge( keyed.begin() + runs[c], keyed.begin() + runs[c + width], keyed.begin() + runs[last] );
+		}
+	}
+
+	codes.resize( num );
+	order.resize( num );
+	bx.resize( num ); by.resize( num ); bz.resize( num ); bm.resize( num );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			unsigned int src = keyed[i].second;
+			codes[i] = keyed[i].first;
+			order[i] = src;
+			bx[i] = positions[src].x;
+			by[i] = positions[src].y;
+			bz[i] = positions[src].z;
+			bm[i] = masses ? masses[src] : 1.0;
+		}
+	}, BH_MIN_CHUNK );
+
+	// the top levels are split here, the cells reached at PARALLEL_LEVEL become
+	// subtrees built on separate threads
+	std::vector<int> tasks;
+	std::vector<int> levels;
+	std::vector<Node> top( 1 );
+	initNode( top[0], 0, (unsigned int)num, rootSize );
+	tasks.push_back( 0 );
+	levels.push_back( 0 );
+	for( size_t t=0; t<tasks.size(); ) {
+		int index = tasks[t];
+		int level = levels[t];
+		if( level == PARALLEL_LEVEL || top[index].end - top[index].begin <= leafSize ) {
+			t++;
+			continue;
+		}
+		splitNode( top, index, level );
+		// the node is replaced by its children in the task list
+		tasks.erase( tasks.begin() + t );
+		levels.erase( levels.begin() + t );
+		for( int c=0; c<top[index].numChildren; c++ ) {
+			tasks.push_back( top[index].firstChild + c );
+			levels.push_back( level + 1 );
+		}
+	}
+
+	std::vector<Subtree> subtrees( tasks.size() );
+	ofParallelForChunks( tasks.size(), 1, [&]( size_t, size_t first, size_t last ) {
+		for( size_t t=first; t<last; t++ ) {
+			std::vector<Node>& sub = subtrees[t].nodes;
+			sub.push_back( top[tasks[t]] );
+			buildNode( sub, 0, levels[t] );
+		}
+	});
+
+	// stitch the subtrees after the top nodes, their roots replace the cells they started from
+	const int numTop = (int)top.size();
+	nodes.swap( top );
+	for( size_t t=0; t<tasks.size(); t++ ) {
+		const std::vector<Node>& sub = subtrees[t].nodes;
+		const int offset = (int)nodes.size() - 1;
+		for( size_t j=0; j<sub.size(); j++ ) {
+			Node n = sub[j];
+			if( n.firstChild != -1 ) {
+				n.firstChild += offset;
+			}
+			if( j == 0 ) {
+				nodes[tasks[t]] = n;
+			} else {
+				nodes.push_back( n );
+			}
+		}
+	}
+	// children always come after their parent
+	for( int i=numTop-1; i>=0; i-- ) {
+		if( nodes[i].firstChild != -1 ) {
+			finalizeNode( nodes, i );
+		}
+	}
+}
+
+void ofBarnesHutd::initNode( Node& node, unsigned int begin, unsigned int end, double size ) const {
+	node.begin = begin;
+	node.end = end;
+	node.size2 = size * size;
+	node.firstChild = -1;
+	node.numChildren = 0;
+	node.cx = node.cy = node.cz = node.mass = 0;
+}
+
+// Appends the children of out[index], they are contiguous.
+void ofBarnesHutd::splitNode( std::vector<Node>& out, int index, int level ) const {
+	const unsigned int begin = out[index].begin, end = out[index].end;
+	const double childSize = sqrt( out[index].size2 ) * 0.5;
+	out[index].firstChild = (int)out.size();
+	out[index].numChildren = 0;
+	unsigned int childBegin = begin;
+	while( childBegin < end ) {
+		// the bodies of a cell are sorted by octant at every level
+		const int octant = getOctant( codes[childBegin], level );
+		unsigned int childEnd = (unsigned int)(std::partition_point( codes.begin() + childBegin, codes.begin() + end,
+			[octant, level]( unsigned long long code ) {
+				return getOctant( code, level ) == octant;
+			}) - codes.begin());
+		Node child;
+		initNode( child, childBegin, childEnd, childSize );
+		out.push_back( child );
+		out[index].numChildren++;
+		childBegin = childEnd;
+	}
+}
+
+// Recursively splits out[index] and computes the centres of mass bottom-up.
+void ofBarnesHutd::buildNode( std::vector<Node>& out, int index, int level ) const {
+	if( out[index].end - out[index].begin > leafSize && level < MORTON_BITS ) {
+		splitNode( out, index, level );
+		const int firstChild = out[index].firstChild;
+		const int numChildren = out[index].numChildren;
+		for( int c=0; c<numChildren; c++ ) {
+			buildNode( out, firstChild + c, level + 1 );
+		}
+	}
+	finalizeNode( out, index );
+}
+
+// Computes the mass and centre of mass of out[index], from its bodies for a
+// leaf or from its children otherwise.
+void ofBarnesHutd::finalizeNode( std::vector<Node>& out, int index ) const {
+	Node& node = out[index];
+	double mass = 0, x = 0, y = 0, z = 0;
+	if( node.firstChild == -1 ) {
+		for( unsigned int i=node.begin; i<node.end; i++ ) {
+			mass += bm[i];
+			x += bm[i] * bx[i];
+			y += bm[i] * by[i];
+			z += bm[i] * bz[i];
+		}
+	} else {
+		for( int c=0; c<node.numChildren; c++ ) {
+			const Node& child = out[node.firstChild + c];
+			mass += child.mass;
+			x += child.mass * child.cx;
+			y += child.mass * child.cy;
+			z += child.mass * child.cz;
+		}
+	}
+	node.mass = mass;
+	if( mass != 0 ) {
+		node.cx = x / mass;
+		node.cy = y / mass;
+		node.cz = z / mass;
+	} else {
+		node.cx = bx[node.begin];
+		node.cy = by[node.begin];
+		node.cz = bz[node.begin];
+	}
+}
+
+
+// Force evaluation.
+//
+//
+ofVec3d ofBarnesHutd::accelerationAt( double x, double y, double z, long long self ) const {
+	const double eps2 = softening * softening;
+	const double theta2 = theta * theta;
+	double ax = 0, ay = 0, az = 0;
+	int stack[256];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node& node = nodes[stack[--stackSize]];
+		double dx = node.cx - x, dy = node.cy - y, dz = node.cz - z;
+		double d2 = dx*dx + dy*dy + dz*dz;
+		bool inside = self >= (long long)node.begin && self < (long long)node.end;
+		if( node.firstChild == -1 ) {
+			// direct sum over the leaf, the body itself contributes nothing
+			const double* px = &bx[0];
+			const double* py = &by[0];
+			const double* pz = &bz[0];
+			const double* pm = &bm[0];
+			for( unsigned int j=node.begin; j<node.end; j++ ) {
+				double ex = px[j] - x, ey = py[j] - y, ez = pz[j] - z;
+				double r2 = ex*ex + ey*ey + ez*ez + eps2;
+				double inv = r2 > 0 ? pm[j] / (r2 * sqrt( r2 )) : 0.0;
+				ax += ex * inv;
+				ay += ey * inv;
+				az += ez * inv;
+			}
+		} else if( !inside && node.size2 < theta2 * d2 ) {
+			double r2 = d2 + eps2;
+			double inv = node.mass / (r2 * sqrt( r2 ));
+			ax += dx * inv;
+			ay += dy * inv;
+			az += dz * inv;
+		} else {
+			for( int c=0; c<node.numChildren; c++ ) {
+				stack[stackSize++] = node.firstChild + c;
+			}
+		}
+	}
+	return ofVec3d( ax * G, ay * G, az * G );
+}
+
+void ofBarnesHutd::computeAccelerations( ofVec3d* accelerations ) const {
+	if( nodes.empty() ) {
+		return;
+	}
+	ofParallelFor( 0, bx.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			accelerations[order[i]] = accelerationAt( bx[i], by[i], bz[i], (long long)i );
+		}
+	}, 256 );
+}
+
+void ofBarnesHutd::computeAccelerations( const ofVec3d* positions, const double* masses, size_t num, ofVec3d* accelerations ) {
+	build( positions, masses, num );
+	computeAccelerations( accelerations );
+}
+
+ofVec3d ofBarnesHutd::getAccelerationAt( const ofVec3d& point ) const {
+	if( nodes.empty() ) {
+		return ofVec3d();
+	}
+	return accelerationAt( point.x, point.y, point.z, -1 );
+}
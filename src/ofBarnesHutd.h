@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief ofBarnesHutd computes gravitational accelerations between many
+/// bodies in O(n log n) with the Barnes–Hut approximation.
+///
+/// The bodies are sorted along a Morton (Z-order) curve, which makes every
+/// octree cell a contiguous range of the sorted arrays. The top of the octree
+/// is split into independent subtrees that are built on separate threads, and
+/// the bodies of a leaf are stored as contiguous component arrays so the
+/// direct leaf interactions are simple loops the compiler can vectorize.
+/// Forces are then evaluated in parallel, one body per iteration.
+///
+/// ~~~~{.cpp}
+/// ofBarnesHutd solver;
+/// solver.setTheta(0.5);
+/// solver.setSoftening(0.01);
+/// solver.computeAccelerations(positions.data(), masses.data(), positions.size(), accelerations.data());
+/// ~~~~
+class ofBarnesHutd {
+public:
+	ofBarnesHutd();
+
+	/// \brief Sets the opening angle. Cells seen under an angle (size / distance)
+	/// smaller than 'theta' are approximated by their centre of mass.
+	/// 0 gives the exact O(n²) sum, 0.5 is a common trade-off.
+	void setTheta( double theta );
+	double getTheta() const;
+
+	/// \brief Sets the softening length added to distances to avoid singularities.
+	void setSoftening( double softening );
+	double getSoftening() const;
+
+	/// \brief Sets the gravitational constant, 1 by default.
+	void setGravitationalConstant( double G );
+	double getGravitationalConstant() const;
+
+	/// \brief Sets the largest number of bodies in a leaf.
+	void setLeafSize( size_t leafSize );
+
+	/// \brief Builds the tree over the bodies.
+	///
+	/// \param masses The mass of each body, or NULL for unit masses.
+	void build( const ofVec3d* positions, const double* masses, size_t num );
+
+	/// \brief Computes the acceleration of every body of the last build().
+	///
+	/// \param accelerations Preallocated array receiving one acceleration per
+	/// body, in the order the bodies were given to build().
+	void computeAccelerations( ofVec3d* accelerations ) const;
+
+	/// \brief Builds the tree and computes the accelerations in one call.
+	void computeAccelerations( const ofVec3d* positions, const double* masses, size_t num, ofVec3d* accelerations );
+
+	/// \brief Returns the acceleration the bodies of the last build() create at 'point'.
+	ofVec3d getAccelerationAt( const ofVec3d& point ) const;
+
+private:
+	struct Node {
+		// centre of mass and total mass
+		double cx, cy, cz, mass;
+		// squared edge length of the cell, for the opening test
+		double size2;
+		// range of sorted bodies
+		unsigned int begin, end;
+		// first child in 'nodes', the children are contiguous; -1 for leaves
+		int firstChild;
+		int numChildren;
+	};
+
+	// nodes of a subtree built on its own thread, stitched into 'nodes' afterwards
+	struct Subtree {
+		std::vector<Node> nodes;
+	};
+
+	void initNode( Node& node, unsigned int begin, unsigned int end, double size ) const;
+	void splitNode( std::vector<Node>& out, int index, int level ) const;
+	void buildNode( std::vector<Node>& out, int index, int level ) const;
+	void finalizeNode( std::vector<Node>& out, int index ) const;
+	ofVec3d accelerationAt( double x, double y, double z, long long self ) const;
+
+	double theta;
+	double softening;
+	double G;
+	size_t leafSize;
+
+	// bodies sorted along the Morton curve
+	std::vector<double> bx, by, bz, bm;
+	std::vector<unsigned long long> codes;
+	std::vector<unsigned int> order;
+	std::vector<Node> nodes;
+};
@@ -0,0 +1,249 @@
+#include "ofDbscand.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+
+namespace {
+
+// smallest number of points worth a thread
+const size_t DBSCAN_MIN_CHUNK = 2048;
+
+// cell coordinates are packed on 21 bits each
+const int DBSCAN_CELL_BITS = 21;
+const long long DBSCAN_CELL_MAX = (1LL << DBSCAN_CELL_BITS) - 1;
+
+const unsigned int DBSCAN_NONE = 0xFFFFFFFFu;
+
+inline long long getCellCoordinate( double v, double invCellSize ) {
+	// far away points share the last cell, which only costs distance checks
+	return MIN( (long long)(v * invCellSize), DBSCAN_CELL_MAX );
+}
+
+inline unsigned long long getCellKey( long long x, long long y, long long z ) {
+	return ((unsigned long long)x << (2 * DBSCAN_CELL_BITS)) | ((unsigned long long)y << DBSCAN_CELL_BITS) | (unsigned long long)z;
+}
+
+// Lock free union-find: a root is only ever linked below a smaller index, with
+// a compare and swap that fails if another thread linked it first.
+class ConcurrentUnionFind {
+public:
+	ConcurrentUnionFind( size_t num )
+	:parents( num ) {
+		for( size_t i=0; i<num; i++ ) {
+			parents[i].store( (unsigned int)i, std::memory_order_relaxed );
+		}
+	}
+
+	unsigned int find( unsigned int x ) {
+		while( true ) {
+			unsigned int parent = parents[x].load( std::memory_order_relaxed );
+			if( parent == x ) {
+				return x;
+			}
+			unsigned int grandParent = parents[parent].load( std::memory_order_relaxed );
+			if( grandParent != parent ) {
+				// path halving
+				parents[x].compare_exchange_weak( parent, grandParent, std::memory_order_relaxed );
+			}
+			x = grandParent;
+		}
+	}
+
+	void unite( unsigned int a, unsigned int b ) {
+		while( true ) {
+			a = find( a );
+			b = find( b );
+			if( a == b ) {
+				return;
+			}
+			if( a < b ) {
+				std::swap( a, b );
+			}
+			unsigned int expected = a;
+			if( parents[a].compare_exchange_strong( expected, b, std::memory_order_relaxed ) ) {
+				return;
+			}
+		}
+	}
+
+private:
+	std::vector< std::atomic<unsigned int> > parents;
+};
+
+}
+
+
+int ofDbscan( const ofVec3d* points, size_t num, double eps, size_t minPoints, std::vector<int>& labels ) {
+	labels.assign( num, -1 );
+	// points, cells and union-find entries are indexed on 32 bits
+	if( points == NULL || num == 0 || num >= DBSCAN_NONE || eps <= 0 ) {
+		return 0;
+	}
+	const double eps2 = eps * eps;
+	const double invCellSize = 1.0 / eps;
+
+	// cells are counted from the lowest corner
+	size_t numChunks = ofGetParallelNumChunks( num, DBSCAN_MIN_CHUNK );
+	std::vector<ofVec3d> chunkMin( numChunks, ofVec3d( DBL_MAX ) );
+	ofParallelForChunks( num, DBSCAN_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		ofVec3d& lo = chunkMin[chunk];
+		for( size_t i=begin; i<end; i++ ) {
+			lo.x = MIN( lo.x, points[i].x );
+			lo.y = MIN( lo.y, points[i].y );
+			lo.z = MIN( lo.z, points[i].z );
+		}
+	});
+	ofVec3d lo = chunkMin[0];
+	for( size_t c=1; c<numChunks; c++ ) {
+		lo.x = MIN( lo.x, chunkMin[c].x );
+		lo.y = MIN( lo.y, chunkMin[c].y );
+		lo.z = MIN( lo.z, chunkMin[c].z );
+	}
+
+	// sort the points by cell: sorted runs in parallel, then merged
+	std::vector< std::pair<unsigned long long, unsigned int> > sorted( num );
+	std::vector<size_t> runs( numChunks + 1, num );
+	ofParallelForChunks( num, DBSCAN_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d p = points[i] - lo;
+			unsigned long long key = getCellKey( getCellCoordinate( p.x, invCellSize ), getCellCoordinate( p.y, invCellSize ), getCellCoordinate( p.z, invCellSize ) );
+			sorted[i] = std::make_pair( key, (unsigned int)i );
+		}
+		std::sort( sorted.begin() + begin, sorted.begin() + end );
+		runs[chunk] = begin;
+	});
+	for( size_t width=1; width<numChunks; width*=2 ) {
+		for( size_t c=0; c + width < numChunks; c += 2*width ) {
+			size_t last = MIN( c + 2*width, numChunks );
+			std::inplace_merge( sorted.begin() + runs[c], sorted.begin() + runs[c + width], sorted.begin() + runs[last] );
+		}
+	}
+
+	// from here points are addressed by their rank in 'sorted'
+	std::vector<ofVec3d> positions( num );
+	std::vector<unsigned int> ranks( num );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t s=begin; s<end; s++ ) {
+			positions[s] = points[sorted[s].second];
+			ranks[sorted[s].second] = (unsigned int)s;
+		}
+	}, DBSCAN_MIN_CHUNK );
+
+	std::vector<unsigned long long> cellKeys;
+	std::vector<unsigned int> cellStarts;
+	std::vector<unsigned int> pointCells( num );
+	for( size_t s=0; s<num; s++ ) {
+		if( s == 0 || sorted[s].first != sorted[s - 1].first ) {
+			cellKeys.push_back( sorted[s].first );
+			cellStarts.push_back( (unsigned int)s );
+		}
+		pointCells[s] = (unsigned int)(cellKeys.size() - 1);
+	}
+	const size_t numCells = cellKeys.size();
+	cellStarts.push_back( (unsigned int)num );
+
+	// the occupied cells among the 27 around every cell
+	std::vector<unsigned int> neighborCells( numCells * 27, DBSCAN_NONE );
+	ofParallelFor( 0, numCells, [&]( size_t begin, size_t end ) {
+		for( size_t c=begin; c<end; c++ ) {
+			const unsigned long long key = cellKeys[c];
+			const long long x = (long long)(key >> (2 * DBSCAN_CELL_BITS));
+			const long long y = (long long)((key >> DBSCAN_CELL_BITS) & DBSCAN_CELL_MAX);
+			const long long z = (long long)(key & DBSCAN_CELL_MAX);
+			unsigned int* out = &neighborCells[c * 27];
+			for( long long nx=MAX( x - 1, 0LL ); nx<=MIN( x + 1, DBSCAN_CELL_MAX ); nx++ ) {
+				for( long long ny=MAX( y - 1, 0LL ); ny<=MIN( y + 1, DBSCAN_CELL_MAX ); ny++ ) {
+					for( long long nz=MAX( z - 1, 0LL ); nz<=MIN( z + 1, DBSCAN_CELL_MAX ); nz++ ) {
+						const unsigned long long neighborKey = getCellKey( nx, ny, nz );
+						std::vector<unsigned long long>::const_iterator it = std::lower_bound( cellKeys.begin(), cellKeys.end(), neighborKey );
+						if( it != cellKeys.end() && *it == neighborKey ) {
+							*out++ = (unsigned int)(it - cellKeys.begin());
+						}
+					}
+				}
+			}
+		}
+	}, DBSCAN_MIN_CHUNK / 8 );
+
+	// core points
+	std::vector<char> core( num, 0 );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t s=begin; s<end; s++ ) {
+			const ofVec3d& p = positions[s];
+			const unsigned int* cells = &neighborCells[(size_t)pointCells[s] * 27];
+			size_t count = 0;
+			for( int n=0; n<27 && cells[n] != DBSCAN_NONE && count < minPoints; n++ ) {
+				for( unsigned int t=cellStarts[cells[n]]; t<cellStarts[cells[n] + 1]; t++ ) {
+					count += p.squareDistance( positions[t] ) <= eps2;
+				}
+			}
+			core[s] = count >= minPoints;
+		}
+	}, DBSCAN_MIN_CHUNK );
+
+	// clusters: every core point is merged with the core points within 'eps'
+	// ranked before it, the other half of the pairs finds it from there
+	ConcurrentUnionFind sets( num );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t s=begin; s<end; s++ ) {
+			if( !core[s] ) {
+				continue;
+			}
+			const ofVec3d& p = positions[s];
+			const unsigned int* cells = &neighborCells[(size_t)pointCells[s] * 27];
+			for( int n=0; n<27 && cells[n] != DBSCAN_NONE; n++ ) {
+				const unsigned int last = MIN( cellStarts[cells[n] + 1], (unsigned int)s );
+				for( unsigned int t=cellStarts[cells[n]]; t<last; t++ ) {
+					if( core[t] && p.squareDistance( positions[t] ) <= eps2 ) {
+						sets.unite( (unsigned int)s, t );
+					}
+				}
+			}
+		}
+	}, DBSCAN_MIN_CHUNK );
+
+	// the cluster root of every point: its own for core points, the one of
+	// the nearest core point for border points
+	std::vector<unsigned int> roots( num, DBSCAN_NONE );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t s=begin; s<end; s++ ) {
+			if( core[s] ) {
+				roots[s] = sets.find( (unsigned int)s );
+				continue;
+			}
+			const ofVec3d& p = positions[s];
+			const unsigned int* cells = &neighborCells[(size_t)pointCells[s] * 27];
+			unsigned int nearest = DBSCAN_NONE;
+			double nearest2 = eps2;
+			for( int n=0; n<27 && cells[n] != DBSCAN_NONE; n++ ) {
+				for( unsigned int t=cellStarts[cells[n]]; t<cellStarts[cells[n] + 1]; t++ ) {
+					double d2 = p.squareDistance( positions[t] );
+					if( core[t] && (d2 < nearest2 || (d2 == nearest2 && t < nearest)) ) {
+						nearest = t;
+						nearest2 = d2;
+					}
+				}
+			}
+			if( nearest != DBSCAN_NONE ) {
+				roots[s] = sets.find( nearest );
+			}
+		}
+	}, DBSCAN_MIN_CHUNK );
+
+	// number the clusters in the order of their first point
+	std::vector<int> clusters( num, -1 );
+	int numClusters = 0;
+	for( size_t i=0; i<num; i++ ) {
+		const unsigned int root = roots[ranks[i]];
+		if( root == DBSCAN_NONE ) {
+			continue;
+		}
+		if( clusters[root] < 0 ) {
+			clusters[root] = numClusters++;
+		}
+		labels[i] = clusters[root];
+	}
+	return numClusters;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief Groups points into clusters of dense regions with DBSCAN, e.g. to
+/// split a lidar scan into objects.
+///
+/// A point with at least 'minPoints' points (itself included) within 'eps'
+/// is a core point. Core points closer than 'eps' to each other belong to the
+/// same cluster. Other points join the cluster of their nearest core point
+/// within 'eps', or are noise.
+///
+/// Neighbourhoods are found on a grid of cells of size 'eps', with the points
+/// sorted by cell. Core points are detected in parallel, and clusters are
+/// merged with a concurrent union-find. Clusters are numbered in the order of
+/// their first point, so the labels do not depend on the number of threads.
+///
+/// Points are indexed on 32 bits: clouds of 2^32 - 1 points or more are not
+/// clustered, every point is labelled as noise.
+///
+/// ~~~~{.cpp}
+/// vector<int> labels;
+/// int numObjects = ofDbscan(scan.data(), scan.size(), 0.3, 10, labels);
+/// for( size_t i = 0; i < scan.size(); i++ ) {
+///     if( labels[i] >= 0 ) objects[labels[i]].push_back(scan[i]);
+/// }
+/// ~~~~
+///
+/// \param eps Radius of the neighbourhood of a point.
+/// \param minPoints Number of points within 'eps' making a point a core point.
+/// \param labels Receives the cluster of every point, from 0, or -1 for noise.
+/// \returns The number of clusters.
+int ofDbscan( const ofVec3d* points, size_t num, double eps, size_t minPoints, std::vector<int>& labels );
@@ -0,0 +1,352 @@
+#include "ofDynamicAabbTreed.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// smallest number of queries worth a thread
+const size_t TREE_MIN_CHUNK = 256;
+
+// how much the displacement stretches the fat boxes
+const double TREE_DISPLACEMENT_MULTIPLIER = 2.0;
+
+}
+
+
+ofDynamicAabbTreed::ofDynamicAabbTreed( double _margin )
+:root(-1)
+,freeList(-1)
+,numProxies(0)
+,margin(_margin) {}
+
+void ofDynamicAabbTreed::setMargin( double _margin ) {
+	margin = _margin;
+}
+
+double ofDynamicAabbTreed::getMargin() const {
+	return margin;
+}
+
+size_t ofDynamicAabbTreed::getNumProxies() const {
+	return numProxies;
+}
+
+int ofDynamicAabbTreed::getHeight() const {
+	return root == -1 ? -1 : nodes[root].height;
+}
+
+void ofDynamicAabbTreed::clear() {
+	nodes.clear();
+	root = -1;
+	freeList = -1;
+	numProxies = 0;
+}
+
+const ofAabbd& ofDynamicAabbTreed::getFatBox( int proxy ) const {
+	return nodes[proxy].box;
+}
+
+
+// Node pool.
+//
+//
+int ofDynamicAabbTreed::allocateNode() {
+	int node;
+	if( freeList != -1 ) {
+		node = freeList;
+		freeList = nodes[node].parent;
+	} else {
+		node = (int)nodes.size();
+		nodes.push_back( Node() );
+	}
+	nodes[node].parent = -1;
+	nodes[node].child1 = -1;
+	nodes[node].child2 = -1;
+	nodes[node].height = 0;
+	return node;
+}
+
+void ofDynamicAabbTreed::freeNode( int node ) {
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+
+// Proxies.
+//
+//
+int ofDynamicAabbTreed::createProxy( const ofAabbd& box ) {
+	int proxy = allocateNode();
+	nodes[proxy].box = box.getExpanded( margin );
+	insertLeaf( proxy );
+	numProxies++;
+	return proxy;
+}
+
+void ofDynamicAabbTreed::destroyProxy( int proxy ) {
+	removeLeaf( proxy );
+	freeNode( proxy );
+	numProxies--;
+}
+
+bool ofDynamicAabbTreed::moveProxy( int proxy, const ofAabbd& box, const ofVec3d& displacement ) {
+	if( nodes[proxy].box.contains( box ) ) {
+		return false;
+	}
+	removeLeaf( proxy );
+	ofAabbd fat = box.getExpanded( margin );
+	ofVec3d d = displacement * TREE_DISPLACEMENT_MULTIPLIER;
+	for( int axis=0; axis<3; axis++ ) {
+		if( d[axis] < 0 ) {
+			fat.min[axis] += d[axis];
+		} else {
+			fat.max[axis] += d[axis];
+		}
+	}
+	nodes[proxy].box = fat;
+	insertLeaf( proxy );
+	return true;
+}
+
+
+// Tree maintenance.
+//
+//
+void ofDynamicAabbTreed::insertLeaf( int leaf ) {
+	if( root == -1 ) {
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	// walk down towards the sibling that grows the surface area the least
+	const ofAabbd leafBox = nodes[leaf].box;
+	int index = root;
+	while( !nodes[index].isLeaf() ) {
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+		double area = nodes[index].box.getSurfaceArea();
+		double combinedArea = nodes[index].box.getMerged( leafBox ).getSurfaceArea();
+
+		// cost of making a new parent for this node and the leaf
+		double cost = 2.0 * combinedArea;
+		// minimum cost of pushing the leaf further down
+		double inheritanceCost = 2.0 * (combinedArea - area);
+
+		double cost1 = leafBox.getMerged( nodes[child1].box ).getSurfaceArea() + inheritanceCost;
+		if( !nodes[child1].isLeaf() ) {
+			cost1 -= nodes[child1].box.getSurfaceArea();
+		}
+		double cost2 = leafBox.getMerged( nodes[child2].box ).getSurfaceArea() + inheritanceCost;
+		if( !nodes[child2].isLeaf() ) {
+			cost2 -= nodes[child2].box.getSurfaceArea();
+		}
+
+		if( cost < cost1 && cost < cost2 ) {
+			break;
+		}
+		index = cost1 < cost2 ? child1 : child2;
+	}
+	int sibling = index;
+
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = leafBox.getMerged( nodes[sibling].box );
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+	if( oldParent != -1 ) {
+		if( nodes[oldParent].child1 == sibling ) {
+			nodes[oldParent].child1 = newParent;
+		} else {
+			nodes[oldParent].child2 = newParent;
+		}
+	} else {
+		root = newParent;
+	}
+
+	fixUpwards( nodes[leaf].parent );
+}
+
+void ofDynamicAabbTreed::removeLeaf( int leaf ) {
+	if( leaf == root ) {
+		root = -1;
+		return;
+	}
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if( grandParent != -1 ) {
+		// the sibling takes the place of the parent
+		if( nodes[grandParent].child1 == parent ) {
+			nodes[grandParent].child1 = sibling;
+		} else {
+			nodes[grandParent].child2 = sibling;
+		}
+		nodes[sibling].parent = grandParent;
+		freeNode( parent );
+		fixUpwards( grandParent );
+	} else {
+		root = sibling;
+		nodes[sibling].parent = -1;
+		freeNode( parent );
+	}
+}
+
+void ofDynamicAabbTreed::fixUpwards( int index ) {
+	while( index != -1 ) {
+		index = balance( index );
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+		nodes[index].height = 1 + MAX( nodes[child1].height, nodes[child2].height );
+		nodes[index].box = nodes[child1].box.getMerged( nodes[child2].box );
+		index = nodes[index].parent;
+	}
+}
+
+// Rotates 'iA' with one of its children if they are out of balance, returns the
+// index of the node now at the top of this subtree.
+int ofDynamicAabbTreed::balance( int iA ) {
+	Node* A = &nodes[iA];
+	if( A->isLeaf() || A->height < 2 ) {
+		return iA;
+	}
+	int iB = A->child1;
+	int iC = A->child2;
+	Node* B = &nodes[iB];
+	Node* C = &nodes[iC];
+	int diff = C->height - B->height;
+
+	if( diff > 1 ) {
+		// rotate C up
+		int iF = C->child1;
+		int iG = C->child2;
+		Node* F = &nodes[iF];
+		Node* G = &nodes[iG];
+
+		C->child1 = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+		if( C->parent != -1 ) {
+			if( nodes[C->parent].child1 == iA ) {
+				nodes[C->parent].child1 = iC;
+			} else {
+				nodes[C->parent].child2 = iC;
+			}
+		} else {
+			root = iC;
+		}
+
+		if( F->height > G->height ) {
+			C->child2 = iF;
+			A->child2 = iG;
+			G->parent = iA;
+			A->box = B->box.getMerged( G->box );
+			C->box = A->box.getMerged( F->box );
+			A->height = 1 + MAX( B->height, G->height );
+			C->height = 1 + MAX( A->height, F->height );
+		} else {
+			C->child2 = iG;
+			A->child2 = iF;
+			F->parent = iA;
+			A->box = B->box.getMerged( F->box );
+			C->box = A->box.getMerged( G->box );
+			A->height = 1 + MAX( B->height, F->height );
+			C->height = 1 + MAX( A->height, G->height );
+		}
+		return iC;
+	}
+
+	if( diff < -1 ) {
+		// rotate B up
+		int iD = B->child1;
+		int iE = B->child2;
+		Node* D = &nodes[iD];
+		Node* E = &nodes[iE];
+
+		B->child1 = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+		if( B->parent != -1 ) {
+			if( nodes[B->parent].child1 == iA ) {
+				nodes[B->parent].child1 = iB;
+			} else {
+				nodes[B->parent].child2 = iB;
+			}
+		} else {
+			root = iB;
+		}
+
+		if( D->height > E->height ) {
+			B->child2 = iD;
+			A->child1 = iE;
+			E->parent = iA;
+			A->box = C->box.getMerged( E->box );
+			B->box = A->box.getMerged( D->box );
+			A->height = 1 + MAX( C->height, E->height );
+			B->height = 1 + MAX( A->height, D->height );
+		} else {
+			B->child2 = iE;
+			A->child1 = iD;
+			D->parent = iA;
+			A->box = C->box.getMerged( D->box );
+			B->box = A->box.getMerged( E->box );
+			A->height = 1 + MAX( C->height, D->height );
+			B->height = 1 + MAX( A->height, E->height );
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+
+// Queries.
+//
+//
+void ofDynamicAabbTreed::query( const ofAabbd& box, std::vector<int>& proxies ) const {
+	query( box, [&]( int proxy ) {
+		proxies.push_back( proxy );
+		return true;
+	});
+}
+
+void ofDynamicAabbTreed::queryPairs( const int* proxies, size_t num, std::vector< std::pair<int, int> >& pairs ) const {
+	size_t numChunks = ofGetParallelNumChunks( num, TREE_MIN_CHUNK );
+	std::vector< std::vector< std::pair<int, int> > > partial( numChunks );
+	ofParallelForChunks( num, TREE_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::vector< std::pair<int, int> >& out = partial[chunk];
+		for( size_t i=begin; i<end; i++ ) {
+			const int proxy = proxies[i];
+			query( nodes[proxy].box, [&]( int other ) {
+				if( other != proxy ) {
+					out.push_back( proxy < other ? std::make_pair( proxy, other ) : std::make_pair( other, proxy ) );
+				}
+				return true;
+			});
+		}
+	});
+	pairs.clear();
+	for( size_t c=0; c<numChunks; c++ ) {
+		pairs.insert( pairs.end(), partial[c].begin(), partial[c].end() );
+	}
+	std::sort( pairs.begin(), pairs.end() );
+	pairs.erase( std::unique( pairs.begin(), pairs.end() ), pairs.end() );
+}
+
+void ofDynamicAabbTreed::findPairs( std::vector< std::pair<int, int> >& pairs ) const {
+	std::vector<int> leaves;
+	leaves.reserve( numProxies );
+	for( size_t i=0; i<nodes.size(); i++ ) {
+		if( nodes[i].height == 0 ) {
+			leaves.push_back( (int)i );
+		}
+	}
+	queryPairs( leaves.empty() ? NULL : &leaves[0], leaves.size(), pairs );
+}
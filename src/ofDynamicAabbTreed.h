@@ -0,0 +1,141 @@
+#pragma once
+
+#include "ofAabbd.h"
+
+#include <utility>
+#include <vector>
+
+/// \brief ofDynamicAabbTreed is a bounding volume hierarchy for objects that
+/// move every frame.
+///
+/// Leaves store "fat" boxes: the object's box grown by a margin. As long as an
+/// object stays inside its fat box, moving it costs nothing; otherwise its leaf
+/// is removed and inserted again. Insertions pick the sibling that grows the
+/// surface area the least and tree rotations keep it balanced, so the tree is
+/// never rebuilt. Nodes are stored in one pooled array and recycled through a
+/// free list, proxy ids are node indices.
+///
+/// ~~~~{.cpp}
+/// ofDynamicAabbTreed tree(0.1);
+/// int proxy = tree.createProxy(body.getBounds());
+/// // every frame
+/// tree.moveProxy(proxy, body.getBounds(), body.getVelocity() * dt);
+/// vector< pair<int, int> > pairs;
+/// tree.findPairs(pairs);
+/// ~~~~
+class ofDynamicAabbTreed {
+public:
+	/// \param margin How much the boxes of the leaves are grown on every side.
+	ofDynamicAabbTreed( double margin = 0.1 );
+
+	void setMargin( double margin );
+	double getMargin() const;
+
+	/// \brief Inserts an object and returns its proxy id.
+	int createProxy( const ofAabbd& box );
+
+	/// \brief Removes an object, its proxy id may be reused.
+	void destroyProxy( int proxy );
+
+	/// \brief Moves an object.
+	///
+	/// \param displacement Expected motion until the next call; the fat box is
+	/// stretched in that direction to avoid reinserting fast objects every frame.
+	/// \returns true if the leaf had to be reinserted.
+	bool moveProxy( int proxy, const ofAabbd& box, const ofVec3d& displacement = ofVec3d() );
+
+	/// \brief Returns the fat box of a proxy.
+	const ofAabbd& getFatBox( int proxy ) const;
+
+	/// \brief Calls 'callback(proxy)' for every proxy whose fat box overlaps
+	/// 'box'. The query stops early when the callback returns false.
+	template<class Callback>
+	void query( const ofAabbd& box, Callback callback ) const;
+
+	/// \brief Appends the proxies whose fat box overlaps 'box' to 'proxies'.
+	void query( const ofAabbd& box, std::vector<int>& proxies ) const;
+
+	/// \brief Finds, in parallel, the proxies overlapping each of 'proxies'.
+	///
+	/// Typically called with the proxies moved this frame. Pairs are unique,
+	/// the smaller id first, sorted.
+	void queryPairs( const int* proxies, size_t num, std::vector< std::pair<int, int> >& pairs ) const;
+
+	/// \brief Finds all the pairs of overlapping proxies.
+	/// \sa queryPairs()
+	void findPairs( std::vector< std::pair<int, int> >& pairs ) const;
+
+	size_t getNumProxies() const;
+
+	/// \brief Returns the height of the tree, 0 for a single leaf, -1 when empty.
+	int getHeight() const;
+
+	/// \brief Removes all the proxies.
+	void clear();
+
+private:
+	struct Node {
+		ofAabbd box;
+		// the parent, or the next free node when in the free list
+		int parent;
+		int child1;
+		int child2;
+		// leaf = 0, free node = -1
+		int height;
+		bool isLeaf() const { return child1 == -1; }
+	};
+
+	int allocateNode();
+	void freeNode( int node );
+	void insertLeaf( int leaf );
+	void removeLeaf( int leaf );
+	int balance( int node );
+	void fixUpwards( int node );
+
+	std::vector<Node> nodes;
+	int root;
+	int freeList;
+	size_t numProxies;
+	double margin;
+};
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+template<class Callback>
+inline void ofDynamicAabbTreed::query( const ofAabbd& box, Callback callback ) const {
+	if( root == -1 ) {
+		return;
+	}
+	int stackBuffer[64];
+	std::vector<int> stackOverflow;
+	int* stack = stackBuffer;
+	size_t stackCapacity = 64;
+	size_t stackSize = 0;
+	stack[stackSize++] = root;
+	while( stackSize > 0 ) {
+		const Node& node = nodes[stack[--stackSize]];
+		if( !node.box.intersects( box ) ) {
+			continue;
+		}
+		if( node.isLeaf() ) {
+			if( !callback( (int)(&node - &nodes[0]) ) ) {
+				return;
+			}
+			continue;
+		}
+		if( stackSize + 2 > stackCapacity ) {
+			if( stack == stackBuffer ) {
+				stackOverflow.assign( stackBuffer, stackBuffer + stackSize );
+			}
+			stackOverflow.resize( stackCapacity * 2 );
+			stack = &stackOverflow[0];
+			stackCapacity *= 2;
+		}
+		stack[stackSize++] = node.child1;
+		stack[stackSize++] = node.child2;
+	}
+}
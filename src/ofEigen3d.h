@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+/// \brief Computes the centroid and the 3x3 covariance matrix of a set of points.
+///
+/// When 'indices' is not null only the points 'points[indices[i]]' are used,
+/// otherwise the first 'num' points are used.
+///
+/// \param points The array of points.
+/// \param indices Optional array of 'num' indices into 'points'.
+/// \param num The number of points (or indices) to use.
+/// \param centroid Receives the average of the points.
+/// \param covariance Receives the (not normalized) covariance matrix.
+void ofComputeCovariance3d( const ofVec3d* points, const size_t* indices, size_t num,
+						   ofVec3d& centroid, double covariance[3][3] );
+
+/// \brief Computes the eigenvalues and eigenvectors of a symmetric 3x3 matrix.
+///
+/// Uses cyclic Jacobi rotations, which is robust for the nearly degenerate
+/// covariance matrices found in point clouds (flat or linear neighbourhoods).
+///
+/// \param matrix The symmetric matrix, only its upper triangle is read.
+/// \param eigenvalues Receives the eigenvalues in ascending order.
+/// \param eigenvectors Receives the unit eigenvectors matching 'eigenvalues'.
+void ofEigenSymmetric3d( const double matrix[3][3], double eigenvalues[3], ofVec3d eigenvectors[3] );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline void ofComputeCovariance3d( const ofVec3d* points, const size_t* indices, size_t num,
+								  ofVec3d& centroid, double covariance[3][3] ) {
+	centroid.set( 0, 0, 0 );
+	for( int r=0; r<3; r++ ) {
+		for( int c=0; c<3; c++ ) {
+			covariance[r][c] = 0.0;
+		}
+	}
+	if( num == 0 ) {
+		return;
+	}
+	for( size_t i=0; i<num; i++ ) {
+		centroid += indices ? points[indices[i]] : points[i];
+	}
+	centroid /= (double)num;
+	double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+	for( size_t i=0; i<num; i++ ) {
+		const ofVec3d& p = indices ? points[indices[i]] : points[i];
+		double dx = p.x - centroid.x;
+		double dy = p.y - centroid.y;
+		double dz = p.z - centroid.z;
+		xx += dx*dx; xy += dx*dy; xz += dx*dz;
+		yy += dy*dy; yz += dy*dz; zz += dz*dz;
+	}
+	covariance[0][0] = xx; covariance[0][1] = xy; covariance[0][2] = xz;
+	covariance[1][0] = xy; covariance[1][1] = yy; covariance[1][2] = yz;
+	covariance[2][0] = xz; covariance[2][1] = yz; covariance[2][2] = zz;
+}
+
+inline void ofEigenSymmetric3d( const double matrix[3][3], double eigenvalues[3], ofVec3d eigenvectors[3] ) {
+	double a[3][3];
+	double v[3][3] = { {1,0,0}, {0,1,0}, {0,0,1} };
+	for( int r=0; r<3; r++ ) {
+		for( int c=r; c<3; c++ ) {
+			a[r][c] = a[c][r] = matrix[r][c];
+		}
+	}
+
+	for( int sweep=0; sweep<32; sweep++ ) {
+		double offDiagonal = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+		double diagonal = fabs(a[0][0]) + fabs(a[1][1]) + fabs(a[2][2]);
+		if( offDiagonal <= 1e-15 * diagonal || offDiagonal == 0.0 ) {
+			break;
+		}
+		for( int p=0; p<2; p++ ) {
+			for( int q=p+1; q<3; q++ ) {
+				if( a[p][q] == 0.0 ) {
+					continue;
+				}
+				// rotation annihilating a[p][q]
+				double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+				double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta*theta + 1.0));
+				double c = 1.0 / sqrt(t*t + 1.0);
+				double s = t * c;
+				for( int k=0; k<3; k++ ) {
+					double akp = a[k][p];
+					double akq = a[k][q];
+					a[k][p] = c*akp - s*akq;
+					a[k][q] = s*akp + c*akq;
+				}
+				for( int k=0; k<3; k++ ) {
+					double apk = a[p][k];
+					double aqk = a[q][k];
+					a[p][k] = c*apk - s*aqk;
+					a[q][k] = s*apk + c*aqk;
+				}
+				for( int k=0; k<3; k++ ) {
+					double vkp = v[k][p];
+					double vkq = v[k][q];
+					v[k][p] = c*vkp - s*vkq;
+					v[k][q] = s*vkp + c*vkq;
+				}
+			}
+		}
+	}
+
+	// sort ascending
+	int order[3] = { 0, 1, 2 };
+	for( int i=0; i<2; i++ ) {
+		for( int j=i+1; j<3; j++ ) {
+			if( a[order[j]][order[j]] < a[order[i]][order[i]] ) {
+				int tmp = order[i];
+				order[i] = order[j];
+				order[j] = tmp;
+			}
+		}
+	}
+	for( int i=0; i<3; i++ ) {
+		int k = order[i];
+		eigenvalues[i] = a[k][k];
+		eigenvectors[i].set( v[0][k], v[1][k], v[2][k] );
+		eigenvectors[i].normalize();
+	}
+}
@@ -0,0 +1,134 @@
+#include "ofFloatingOrigind.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// smallest number of positions worth a thread
+const size_t ORIGIN_MIN_CHUNK = 16384;
+
+}
+
+
+ofFloatingOrigind::ofFloatingOrigind()
+:origin(0, 0, 0)
+,rebaseDistance(0) {}
+
+
+// Arrays.
+//
+//
+void ofFloatingOrigind::add( ofVec3d* positions, size_t num, ofVec3f* localCopies ) {
+	if( positions == NULL ) {
+		return;
+	}
+	remove( positions );
+	Array array;
+	array.positions = positions;
+	array.localCopies = localCopies;
+	array.num = num;
+	arrays.push_back( array );
+}
+
+void ofFloatingOrigind::remove( const ofVec3d* positions ) {
+	for( size_t i=0; i<arrays.size(); i++ ) {
+		if( arrays[i].positions == positions ) {
+			arrays.erase( arrays.begin() + i );
+			return;
+		}
+	}
+}
+
+void ofFloatingOrigind::clear() {
+	arrays.clear();
+}
+
+size_t ofFloatingOrigind::getNumArrays() const {
+	return arrays.size();
+}
+
+size_t ofFloatingOrigind::getNumPositions() const {
+	size_t num = 0;
+	for( size_t i=0; i<arrays.size(); i++ ) {
+		num += arrays[i].num;
+	}
+	return num;
+}
+
+
+// Origin.
+//
+//
+const ofVec3d& ofFloatingOrigind::getOrigin() const {
+	return origin;
+}
+
+void ofFloatingOrigind::setOrigin( const ofVec3d& newOrigin ) {
+	moveOrigin( newOrigin - origin );
+}
+
+void ofFloatingOrigind::moveOrigin( const ofVec3d& offset ) {
+	// a copy: 'offset' may be one of the registered positions
+	const ofVec3d delta = offset;
+	rebase( delta, true );
+	origin += delta;
+}
+
+void ofFloatingOrigind::setRebaseDistance( double distance ) {
+	rebaseDistance = distance;
+}
+
+double ofFloatingOrigind::getRebaseDistance() const {
+	return rebaseDistance;
+}
+
+bool ofFloatingOrigind::update( const ofVec3d& focus ) {
+	if( rebaseDistance <= 0 || focus.lengthSquared() <= rebaseDistance * rebaseDistance ) {
+		return false;
+	}
+	moveOrigin( focus );
+	return true;
+}
+
+void ofFloatingOrigind::updateLocalCopies() {
+	rebase( ofVec3d( 0, 0, 0 ), false );
+}
+
+ofVec3d ofFloatingOrigind::toWorld( const ofVec3d& local ) const {
+	return local + origin;
+}
+
+ofVec3d ofFloatingOrigind::toLocal( const ofVec3d& world ) const {
+	return world - origin;
+}
+
+void ofFloatingOrigind::rebase( const ofVec3d& offset, bool move ) {
+	// the arrays are laid end to end so one parallel loop covers all of them,
+	// however they are sized
+	std::vector<size_t> starts( arrays.size() + 1, 0 );
+	for( size_t a=0; a<arrays.size(); a++ ) {
+		starts[a + 1] = starts[a] + arrays[a].num;
+	}
+	ofParallelFor( 0, starts.back(), [&]( size_t begin, size_t end ) {
+		size_t a = std::upper_bound( starts.begin(), starts.end(), begin ) - starts.begin() - 1;
+		for( ; begin<end; a++ ) {
+			const Array& array = arrays[a];
+			const size_t first = begin - starts[a];
+			const size_t last = MIN( end, starts[a + 1] ) - starts[a];
+			ofVec3d* positions = array.positions;
+			if( move ) {
+				for( size_t i=first; i<last; i++ ) {
+					positions[i] -= offset;
+				}
+			}
+			if( array.localCopies != NULL ) {
+				ofVec3f* copies = array.localCopies;
+				for( size_t i=first; i<last; i++ ) {
+					copies[i] = positions[i];
+				}
+			}
+			begin = starts[a] + last;
+		}
+	}, ORIGIN_MIN_CHUNK );
+}
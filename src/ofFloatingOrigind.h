@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief ofFloatingOrigind keeps registered ofVec3d arrays relative to a
+/// movable origin, so positions near the viewer stay small at planetary scale.
+///
+/// The positions are stored relative to getOrigin(). Moving the origin
+/// subtracts the offset from every registered array in one parallel pass over
+/// all of them, which can also write float copies of the positions for
+/// rendering. Positions far from the origin lose precision in float; after a
+/// rebase the copies near the new origin are exact to float precision again.
+///
+/// Registered arrays must stay valid, and be registered again if they are
+/// reallocated. Nothing else may read or write them during a rebase.
+///
+/// ~~~~{.cpp}
+/// ofFloatingOrigind origin;
+/// origin.setRebaseDistance(10000);
+/// origin.add(asteroids.data(), asteroids.size(), asteroidsFloat.data());
+/// origin.add(&shipPosition, 1);
+/// // every frame, after the simulation moved the ship
+/// if( !origin.update(shipPosition) ) {
+///     origin.updateLocalCopies();
+/// }
+/// vbo.updateVertexData(asteroidsFloat.data(), asteroidsFloat.size());
+/// ~~~~
+class ofFloatingOrigind {
+public:
+	ofFloatingOrigind();
+
+	/// \brief Registers 'num' positions, relative to the current origin.
+	///
+	/// \param localCopies Optional array of 'num' values receiving the
+	/// positions in float every time they are rebased or updateLocalCopies()
+	/// is called.
+	void add( ofVec3d* positions, size_t num, ofVec3f* localCopies = NULL );
+
+	/// \brief Unregisters the array starting at 'positions'.
+	void remove( const ofVec3d* positions );
+	void clear();
+
+	size_t getNumArrays() const;
+
+	/// \brief Returns the number of registered positions, over all the arrays.
+	size_t getNumPositions() const;
+
+	/// \brief Returns the world position of the origin.
+	const ofVec3d& getOrigin() const;
+
+	/// \brief Moves the origin to the world position 'origin', rebasing all
+	/// the registered positions and their float copies.
+	void setOrigin( const ofVec3d& origin );
+
+	/// \brief Moves the origin by 'offset', given relative to the current origin.
+	void moveOrigin( const ofVec3d& offset );
+
+	/// \brief Distance from the origin beyond which update() rebases, 0 to never rebase.
+	void setRebaseDistance( double distance );
+	double getRebaseDistance() const;
+
+	/// \brief Moves the origin to 'focus', relative to the current origin,
+	/// if it is farther than the rebase distance. Returns true if it did.
+	bool update( const ofVec3d& focus );
+
+	/// \brief Writes the float copies of all the positions, without rebasing.
+	void updateLocalCopies();
+
+	/// \brief Converts a position relative to the origin to a world position.
+	ofVec3d toWorld( const ofVec3d& local ) const;
+
+	/// \brief Converts a world position to a position relative to the origin.
+	ofVec3d toLocal( const ofVec3d& world ) const;
+
+private:
+	struct Array {
+		ofVec3d* positions;
+		ofVec3f* localCopies;
+		size_t num;
+	};
+
+	// Subtracts 'offset' from all the positions and writes the float copies.
+	void rebase( const ofVec3d& offset, bool move );
+
+	std::vector<Array> arrays;
+	ofVec3d origin;
+	double rebaseDistance;
+};
@@ -0,0 +1,137 @@
+#include "ofFrustumd.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of objects worth a thread
+const size_t CULL_MIN_CHUNK = 16384;
+
+// Runs 'isVisible(i)' over [0, num) in parallel chunks and collects the visible
+// indices in order. Flags are computed first so the test loop has no branches.
+template<class Test>
+void cull( size_t num, std::vector<unsigned int>& visible, Test isVisible ) {
+	size_t numChunks = ofGetParallelNumChunks( num, CULL_MIN_CHUNK );
+	std::vector< std::vector<unsigned int> > partial( numChunks );
+	ofParallelForChunks( num, CULL_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::vector<unsigned char> flags( end - begin );
+		for( size_t i=begin; i<end; i++ ) {
+			flags[i - begin] = isVisible( i );
+		}
+		std::vector<unsigned int>& out = partial[chunk];
+		for( size_t i=begin; i<end; i++ ) {
+			if( flags[i - begin] ) {
+				out.push_back( (unsigned int)i );
+			}
+		}
+	});
+	visible.clear();
+	size_t total = 0;
+	for( size_t c=0; c<numChunks; c++ ) {
+		total += partial[c].size();
+	}
+	visible.reserve( total );
+	for( size_t c=0; c<numChunks; c++ ) {
+		visible.insert( visible.end(), partial[c].begin(), partial[c].end() );
+	}
+}
+
+}
+
+
+ofFrustumd::ofFrustumd() {
+	for( int i=0; i<6; i++ ) {
+		planes[i].set( 0, 0, 0, 1 );
+	}
+}
+
+void ofFrustumd::setFromMatrix( const double* m ) {
+	// Gribb & Hartmann: the planes are sums and differences of the matrix rows
+	ofVec4d row0( m[0], m[4], m[8], m[12] );
+	ofVec4d row1( m[1], m[5], m[9], m[13] );
+	ofVec4d row2( m[2], m[6], m[10], m[14] );
+	ofVec4d row3( m[3], m[7], m[11], m[15] );
+	ofVec4d extracted[6] = {
+		row3 + row0,
+		row3 - row0,
+		row3 + row1,
+		row3 - row1,
+		row3 + row2,
+		row3 - row2
+	};
+	setPlanes( extracted );
+}
+
+void ofFrustumd::setPlanes( const ofVec4d* _planes ) {
+	for( int i=0; i<6; i++ ) {
+		const ofVec4d& p = _planes[i];
+		double length = sqrt( p.x*p.x + p.y*p.y + p.z*p.z );
+		planes[i] = length > 0 ? p / length : p;
+	}
+}
+
+const ofVec4d& ofFrustumd::getPlane( int i ) const {
+	return planes[i];
+}
+
+bool ofFrustumd::isSphereVisible( const ofVec3d& c, double radius ) const {
+	for( int i=0; i<6; i++ ) {
+		const ofVec4d& p = planes[i];
+		if( p.x*c.x + p.y*c.y + p.z*c.z + p.w < -radius ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ofFrustumd::isBoxVisible( const ofAabbd& box ) const {
+	ofVec3d c = box.getCenter();
+	ofVec3d e = box.getExtents();
+	for( int i=0; i<6; i++ ) {
+		const ofVec4d& p = planes[i];
+		double r = fabs(p.x)*e.x + fabs(p.y)*e.y + fabs(p.z)*e.z;
+		if( p.x*c.x + p.y*c.y + p.z*c.z + p.w < -r ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ofCullSpheres( const ofFrustumd& frustum, const ofVec3d* centers, const double* radii, size_t num,
+				   std::vector<unsigned int>& visible ) {
+	double nx[6], ny[6], nz[6], d[6];
+	for( int i=0; i<6; i++ ) {
+		const ofVec4d& p = frustum.getPlane( i );
+		nx[i] = p.x; ny[i] = p.y; nz[i] = p.z; d[i] = p.w;
+	}
+	cull( num, visible, [&]( size_t i ) {
+		const ofVec3d& c = centers[i];
+		const double r = -radii[i];
+		bool inside = true;
+		for( int k=0; k<6; k++ ) {
+			inside &= nx[k]*c.x + ny[k]*c.y + nz[k]*c.z + d[k] >= r;
+		}
+		return inside;
+	});
+}
+
+void ofCullBoxes( const ofFrustumd& frustum, const ofAabbd* boxes, size_t num,
+				 std::vector<unsigned int>& visible ) {
+	double nx[6], ny[6], nz[6], ax[6], ay[6], az[6], d[6];
+	for( int i=0; i<6; i++ ) {
+		const ofVec4d& p = frustum.getPlane( i );
+		nx[i] = p.x; ny[i] = p.y; nz[i] = p.z; d[i] = p.w;
+		ax[i] = fabs(p.x); ay[i] = fabs(p.y); az[i] = fabs(p.z);
+	}
+	cull( num, visible, [&]( size_t i ) {
+		const ofAabbd& b = boxes[i];
+		const double cx = (b.min.x + b.max.x) * 0.5, ex = (b.max.x - b.min.x) * 0.5;
+		const double cy = (b.min.y + b.max.y) * 0.5, ey = (b.max.y - b.min.y) * 0.5;
+		const double cz = (b.min.z + b.max.z) * 0.5, ez = (b.max.z - b.min.z) * 0.5;
+		bool inside = true;
+		for( int k=0; k<6; k++ ) {
+			double r = ax[k]*ex + ay[k]*ey + az[k]*ez;
+			inside &= nx[k]*cx + ny[k]*cy + nz[k]*cz + d[k] >= -r;
+		}
+		return inside;
+	});
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofVec3d.h"
+#include "ofVec4d.h"
+#include "ofAabbd.h"
+
+#include <vector>
+
+/// \brief ofFrustumd is a view frustum stored as six double precision planes.
+///
+/// Each plane is an ofVec4d (nx, ny, nz, d) with its normal pointing inside:
+/// a point 'p' is on the inner side when 'nx*p.x + ny*p.y + nz*p.z + d >= 0'.
+class ofFrustumd {
+public:
+	enum Plane {
+		LEFT_PLANE = 0,
+		RIGHT_PLANE,
+		BOTTOM_PLANE,
+		TOP_PLANE,
+		NEAR_PLANE,
+		FAR_PLANE
+	};
+
+	ofFrustumd();
+
+	/// \brief Extracts the planes of a view-projection matrix stored like
+	/// OpenGL and ofMatrix4x4::getPtr().
+	void setFromMatrix( const double* viewProjection );
+
+	/// \brief Sets the six planes, in the order of Plane. They are normalized.
+	void setPlanes( const ofVec4d* planes );
+
+	const ofVec4d& getPlane( int i ) const;
+
+	/// \brief Returns false only if the sphere is entirely outside a plane.
+	bool isSphereVisible( const ofVec3d& center, double radius ) const;
+
+	/// \brief Returns false only if the box is entirely outside a plane.
+	bool isBoxVisible( const ofAabbd& box ) const;
+
+private:
+	ofVec4d planes[6];
+};
+
+/// \brief Culls spheres against a frustum.
+///
+/// Spheres are tested in chunks spread over threads; every chunk first
+/// computes a visibility flag per sphere with a branch-free loop over the six
+/// planes, then compacts the visible indices.
+///
+/// ~~~~{.cpp}
+/// vector<unsigned int> visible;
+/// ofCullSpheres(frustum, centers.data(), radii.data(), centers.size(), visible);
+/// for( size_t i = 0; i < visible.size(); i++ ) {
+///     draw(objects[visible[i]]);
+/// }
+/// ~~~~
+///
+/// \param centers The centres of the spheres.
+/// \param radii The radii of the spheres.
+/// \param num The number of spheres.
+/// \param visible Receives the indices of the visible spheres, in increasing order.
+void ofCullSpheres( const ofFrustumd& frustum, const ofVec3d* centers, const double* radii, size_t num,
+				   std::vector<unsigned int>& visible );
+
+/// \brief Culls axis aligned boxes against a frustum.
+/// \sa ofCullSpheres()
+void ofCullBoxes( const ofFrustumd& frustum, const ofAabbd* boxes, size_t num,
+				 std::vector<unsigned int>& visible );
@@ -0,0 +1,438 @@
+#include "ofKMeansd.h"
+#include "ofRandomd.h"
+#include "ofVecXdParallel.h"
+
+#include <limits>
+
+namespace {
+
+// smallest number of points worth a thread
+const size_t KMEANS_MIN_CHUNK = 1024;
+
+// sums are accumulated per block of this many points, then added block after
+// block, so they do not depend on the number of threads
+const size_t KMEANS_BLOCK = 8192;
+
+
+template<int D>
+inline double getDistance2( const double* a, const double* b ) {
+	double d2 = 0;
+	for( int d=0; d<D; d++ ) {
+		d2 += (a[d] - b[d]) * (a[d] - b[d]);
+	}
+	return d2;
+}
+
+// Calls 'fn(block, begin, end)' on the blocks of [0, num), in parallel.
+template<class Function>
+void forEachBlock( size_t num, Function fn ) {
+	const size_t numBlocks = (num + KMEANS_BLOCK - 1) / KMEANS_BLOCK;
+	ofParallelFor( 0, numBlocks, [&]( size_t first, size_t last ) {
+		for( size_t b=first; b<last; b++ ) {
+			fn( b, b * KMEANS_BLOCK, MIN( (b + 1) * KMEANS_BLOCK, num ) );
+		}
+	}, 1 );
+}
+
+
+// The centers, stored coordinate after coordinate so the distances from a
+// point to all of them are computed by loops the compiler vectorises.
+template<int D>
+class Centers {
+public:
+	void setup( int _k ) {
+		k = _k;
+		coords.assign( (size_t)k * D, 0.0 );
+	}
+
+	void set( int j, const double* p ) {
+		for( int d=0; d<D; d++ ) {
+			coords[(size_t)d * k + j] = p[d];
+		}
+	}
+
+	void get( int j, double* p ) const {
+		for( int d=0; d<D; d++ ) {
+			p[d] = coords[(size_t)d * k + j];
+		}
+	}
+
+	double getDistance2( int j, const double* p ) const {
+		double d2 = 0;
+		for( int d=0; d<D; d++ ) {
+			double diff = coords[(size_t)d * k + j] - p[d];
+			d2 += diff * diff;
+		}
+		return d2;
+	}
+
+	// Index of the center nearest to 'p', with the squared distances to it and
+	// to the second nearest one. 'd2' is scratch space for 'k' values.
+	int getNearest( const double* p, double* d2, double& best2, double& second2 ) const {
+		for( int j=0; j<k; j++ ) {
+			d2[j] = 0;
+		}
+		for( int d=0; d<D; d++ ) {
+			const double* c = &coords[(size_t)d * k];
+			const double x = p[d];
+			for( int j=0; j<k; j++ ) {
+				d2[j] += (c[j] - x) * (c[j] - x);
+			}
+		}
+		int best = 0;
+		best2 = d2[0];
+		second2 = std::numeric_limits<double>::infinity();
+		for( int j=1; j<k; j++ ) {
+			if( d2[j] < best2 ) {
+				second2 = best2;
+				best2 = d2[j];
+				best = j;
+			} else if( d2[j] < second2 ) {
+				second2 = d2[j];
+			}
+		}
+		return best;
+	}
+
+	int k;
+	std::vector<double> coords;
+};
+
+
+// k-means++: every center is drawn with a probability proportional to the
+// squared distance to the nearest center already chosen.
+template<int D>
+void seedCenters( const double* points, size_t num, int k, ofRandomGeneratord& rng, Centers<D>& centers ) {
+	centers.setup( k );
+	const size_t numBlocks = (num + KMEANS_BLOCK - 1) / KMEANS_BLOCK;
+	std::vector<double> minD2( num, std::numeric_limits<double>::infinity() );
+	std::vector<double> blockSums( numBlocks );
+	size_t index = MIN( (size_t)(rng.getUniform() * num), num - 1 );
+	for( int j=0; j<k; j++ ) {
+		const double* c = &points[index * D];
+		centers.set( j, c );
+		if( j == k - 1 ) {
+			break;
+		}
+		forEachBlock( num, [&]( size_t b, size_t begin, size_t end ) {
+			double sum = 0;
+			for( size_t i=begin; i<end; i++ ) {
+				minD2[i] = MIN( minD2[i], getDistance2<D>( &points[i * D], c ) );
+				sum += minD2[i];
+			}
+			blockSums[b] = sum;
+		});
+		double total = 0;
+		for( size_t b=0; b<numBlocks; b++ ) {
+			total += blockSums[b];
+		}
+		if( total <= 0 ) {
+			// every point sits on a center already
+			index = MIN( (size_t)(rng.getUniform() * num), num - 1 );
+			continue;
+		}
+		double r = rng.getUniform() * total;
+		size_t b = 0;
+		while( b < numBlocks - 1 && r >= blockSums[b] ) {
+			r -= blockSums[b];
+			b++;
+		}
+		const size_t begin = b * KMEANS_BLOCK, end = MIN( begin + KMEANS_BLOCK, num );
+		index = begin;
+		while( index < end - 1 && r >= minD2[index] ) {
+			r -= minD2[index];
+			index++;
+		}
+		// rounding may stop on a point that is already a center
+		while( minD2[index] == 0 && index > begin ) {
+			index--;
+		}
+	}
+}
+
+
+// Assigns every point to its nearest center, optionally storing the distance
+// bounds used by Hamerly's algorithm. Returns the sum of squared distances.
+template<int D>
+double assignAll( const double* points, size_t num, const Centers<D>& centers, int* labels, double* upper, double* lower ) {
+	const size_t numBlocks = (num + KMEANS_BLOCK - 1) / KMEANS_BLOCK;
+	std::vector<double> blockSums( numBlocks );
+	forEachBlock( num, [&]( size_t b, size_t begin, size_t end ) {
+		std::vector<double> d2( centers.k );
+		double sum = 0;
+		for( size_t i=begin; i<end; i++ ) {
+			double best2, second2;
+			labels[i] = centers.getNearest( &points[i * D], d2.data(), best2, second2 );
+			if( upper != NULL ) {
+				upper[i] = sqrt( best2 );
+				lower[i] = sqrt( second2 );
+			}
+			sum += best2;
+		}
+		blockSums[b] = sum;
+	});
+	double total = 0;
+	for( size_t b=0; b<numBlocks; b++ ) {
+		total += blockSums[b];
+	}
+	return total;
+}
+
+template<int D>
+double getInertia( const double* points, size_t num, const Centers<D>& centers, const int* labels ) {
+	const size_t numBlocks = (num + KMEANS_BLOCK - 1) / KMEANS_BLOCK;
+	std::vector<double> blockSums( numBlocks );
+	forEachBlock( num, [&]( size_t b, size_t begin, size_t end ) {
+		double sum = 0;
+		for( size_t i=begin; i<end; i++ ) {
+			sum += centers.getDistance2( labels[i], &points[i * D] );
+		}
+		blockSums[b] = sum;
+	});
+	double total = 0;
+	for( size_t b=0; b<numBlocks; b++ ) {
+		total += blockSums[b];
+	}
+	return total;
+}
+
+// Moves every center to the mean of its points; empty clusters keep their center.
+template<int D>
+void updateMeans( const double* points, size_t num, const int* labels, Centers<D>& centers, std::vector<double>& sums ) {
+	const int k = centers.k;
+	const size_t stride = (size_t)k * (D + 1);
+	const size_t numBlocks = (num + KMEANS_BLOCK - 1) / KMEANS_BLOCK;
+	sums.assign( numBlocks * stride, 0.0 );
+	forEachBlock( num, [&]( size_t b, size_t begin, size_t end ) {
+		double* s = &sums[b * stride];
+		for( size_t i=begin; i<end; i++ ) {
+			double* cluster = &s[(size_t)labels[i] * (D + 1)];
+			for( int d=0; d<D; d++ ) {
+				cluster[d] += points[i * D + d];
+			}
+			cluster[D] += 1;
+		}
+	});
+	for( int j=0; j<k; j++ ) {
+		double mean[D + 1] = {};
+		for( size_t b=0; b<numBlocks; b++ ) {
+			const double* cluster = &sums[b * stride + (size_t)j * (D + 1)];
+			for( int d=0; d<=D; d++ ) {
+				mean[d] += cluster[d];
+			}
+		}
+		if( mean[D] > 0 ) {
+			for( int d=0; d<D; d++ ) {
+				mean[d] /= mean[D];
+			}
+			centers.set( j, mean );
+		}
+	}
+}
+
+
+// Lloyd's iterations with Hamerly's bounds: 'upper' bounds the distance of a
+// point to its center, 'lower' the distance to any other center. A point only
+// needs all its distances when the bounds no longer separate them.
+template<int D>
+void runHamerly( const double* points, size_t num, const ofKMeansSettings& settings, Centers<D>& centers, std::vector<int>& labels ) {
+	const int k = centers.k;
+	std::vector<double> upper( num ), lower( num );
+	assignAll( points, num, centers, labels.data(), upper.data(), lower.data() );
+
+	Centers<D> previous;
+	std::vector<double> moves( k ), half( k ), sums;
+	for( int iteration=0; iteration<settings.maxIterations; iteration++ ) {
+		previous = centers;
+		updateMeans( points, num, labels.data(), centers, sums );
+
+		double maxMove = 0, secondMove = 0;
+		int maxMoveIndex = -1;
+		for( int j=0; j<k; j++ ) {
+			double c[D];
+			previous.get( j, c );
+			moves[j] = sqrt( centers.getDistance2( j, c ) );
+			if( moves[j] > maxMove ) {
+				secondMove = maxMove;
+				maxMove = moves[j];
+				maxMoveIndex = j;
+			} else if( moves[j] > secondMove ) {
+				secondMove = moves[j];
+			}
+		}
+		if( maxMove == 0 ) {
+			// the labels already match the centers
+			break;
+		}
+		// small moves still get a last assignment, so the labels match the centers
+		const bool converged = maxMove <= settings.tolerance;
+
+		// half the distance from every center to the nearest other one: closer
+		// than that to its center, a point cannot be closer to another
+		for( int j=0; j<k; j++ ) {
+			double c[D], nearest2 = std::numeric_limits<double>::infinity();
+			centers.get( j, c );
+			for( int other=0; other<k; other++ ) {
+				if( other != j ) {
+					nearest2 = MIN( nearest2, centers.getDistance2( other, c ) );
+				}
+			}
+			half[j] = 0.5 * sqrt( nearest2 );
+		}
+
+		const size_t numChunks = ofGetParallelNumChunks( num, KMEANS_MIN_CHUNK );
+		std::vector<size_t> changed( numChunks, 0 );
+		ofParallelForChunks( num, KMEANS_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+			std::vector<double> d2( k );
+			for( size_t i=begin; i<end; i++ ) {
+				const int label = labels[i];
+				upper[i] += moves[label];
+				lower[i] -= label == maxMoveIndex ? secondMove : maxMove;
+				const double bound = MAX( half[label], lower[i] );
+				if( upper[i] <= bound ) {
+					continue;
+				}
+				const double* p = &points[i * D];
+				upper[i] = sqrt( centers.getDistance2( label, p ) );
+				if( upper[i] <= bound ) {
+					continue;
+				}
+				double best2, second2;
+				labels[i] = centers.getNearest( p, d2.data(), best2, second2 );
+				upper[i] = sqrt( best2 );
+				lower[i] = sqrt( second2 );
+				if( labels[i] != label ) {
+					changed[chunk]++;
+				}
+			}
+		});
+		size_t numChanged = 0;
+		for( size_t c=0; c<numChunks; c++ ) {
+			numChanged += changed[c];
+		}
+		if( numChanged == 0 || converged ) {
+			break;
+		}
+	}
+}
+
+
+// Mini-batch k-means: every iteration moves the centers toward a random batch
+// of points, each center with a rate of one over the number of points it saw.
+template<int D>
+void runMiniBatch( const double* points, size_t num, const ofKMeansSettings& settings, ofRandomGeneratord& rng, Centers<D>& centers ) {
+	const int k = centers.k;
+	const size_t batchSize = MIN( settings.batchSize, num );
+	std::vector<double> u( batchSize );
+	std::vector<size_t> batch( batchSize );
+	std::vector<int> nearest( batchSize );
+	std::vector<double> counts( k, 0.0 );
+	Centers<D> previous;
+	for( int iteration=0; iteration<settings.maxIterations; iteration++ ) {
+		rng.getUniform( u.data(), batchSize );
+		for( size_t i=0; i<batchSize; i++ ) {
+			batch[i] = MIN( (size_t)(u[i] * num), num - 1 );
+		}
+		ofParallelFor( 0, batchSize, [&]( size_t begin, size_t end ) {
+			std::vector<double> d2( k );
+			for( size_t i=begin; i<end; i++ ) {
+				double best2, second2;
+				nearest[i] = centers.getNearest( &points[batch[i] * D], d2.data(), best2, second2 );
+			}
+		}, KMEANS_MIN_CHUNK );
+
+		if( settings.tolerance > 0 ) {
+			previous = centers;
+		}
+		// in batch order, so the result does not depend on the threads
+		for( size_t i=0; i<batchSize; i++ ) {
+			const int j = nearest[i];
+			const double* p = &points[batch[i] * D];
+			counts[j] += 1;
+			const double rate = 1.0 / counts[j];
+			for( int d=0; d<D; d++ ) {
+				double& c = centers.coords[(size_t)d * k + j];
+				c += (p[d] - c) * rate;
+			}
+		}
+
+		if( settings.tolerance > 0 ) {
+			double maxMove2 = 0;
+			for( int j=0; j<k; j++ ) {
+				double c[D];
+				previous.get( j, c );
+				maxMove2 = MAX( maxMove2, centers.getDistance2( j, c ) );
+			}
+			if( maxMove2 <= settings.tolerance * settings.tolerance ) {
+				break;
+			}
+		}
+	}
+}
+
+
+template<int D, class Vec>
+double kMeans( const Vec* points, size_t num, int k, const ofKMeansSettings& settings,
+			  std::vector<Vec>& centersOut, std::vector<int>& labels ) {
+	static_assert( sizeof(Vec) == D * sizeof(double), "Vec must be made of doubles only" );
+	centersOut.clear();
+	labels.clear();
+	if( points == NULL || num == 0 || k <= 0 ) {
+		return 0;
+	}
+	k = (int)MIN( (size_t)k, num );
+	const double* coords = points[0].getPtr();
+	ofRandomGeneratord rng( settings.seed );
+	Centers<D> centers;
+	labels.resize( num );
+	double inertia;
+	if( settings.batchSize == 0 ) {
+		seedCenters( coords, num, k, rng, centers );
+		runHamerly( coords, num, settings, centers, labels );
+		inertia = getInertia( coords, num, centers, labels.data() );
+	} else {
+		// seeding on all the points would cost more than the mini-batches
+		const size_t sampleSize = MIN( num, MAX( settings.batchSize, (size_t)k ) * 3 );
+		std::vector<double> u( sampleSize ), sample( sampleSize * D );
+		rng.getUniform( u.data(), sampleSize );
+		for( size_t i=0; i<sampleSize; i++ ) {
+			const size_t index = MIN( (size_t)(u[i] * num), num - 1 );
+			for( int d=0; d<D; d++ ) {
+				sample[i * D + d] = coords[index * D + d];
+			}
+		}
+		seedCenters( sample.data(), sampleSize, k, rng, centers );
+		runMiniBatch( coords, num, settings, rng, centers );
+		inertia = assignAll( coords, num, centers, labels.data(), (double*)NULL, (double*)NULL );
+	}
+	centersOut.resize( k );
+	for( int j=0; j<k; j++ ) {
+		centers.get( j, centersOut[j].getPtr() );
+	}
+	return inertia;
+}
+
+}
+
+
+ofKMeansSettings::ofKMeansSettings() {
+	maxIterations = 100;
+	tolerance = 0;
+	batchSize = 0;
+	seed = 0;
+}
+
+double ofKMeans( const ofVec2d* points, size_t num, int k, const ofKMeansSettings& settings,
+				std::vector<ofVec2d>& centers, std::vector<int>& labels ) {
+	return kMeans<2>( points, num, k, settings, centers, labels );
+}
+
+double ofKMeans( const ofVec3d* points, size_t num, int k, const ofKMeansSettings& settings,
+				std::vector<ofVec3d>& centers, std::vector<int>& labels ) {
+	return kMeans<3>( points, num, k, settings, centers, labels );
+}
+
+double ofKMeans( const ofVec4d* points, size_t num, int k, const ofKMeansSettings& settings,
+				std::vector<ofVec4d>& centers, std::vector<int>& labels ) {
+	return kMeans<4>( points, num, k, settings, centers, labels );
+}
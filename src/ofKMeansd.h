@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ofVec2d.h"
+#include "ofVec3d.h"
+#include "ofVec4d.h"
+
+#include <vector>
+
+/// \brief Settings of ofKMeans().
+///
+/// ~~~~{.cpp}
+/// ofKMeansSettings settings;
+/// settings.batchSize = 4096; // mini-batch, for millions of colours
+/// vector<ofVec3d> palette;
+/// vector<int> labels;
+/// ofKMeans(colors.data(), colors.size(), 256, settings, palette, labels);
+/// ~~~~
+struct ofKMeansSettings {
+	ofKMeansSettings();
+
+	/// \brief Upper bound on the number of iterations.
+	int maxIterations;
+
+	/// \brief The clustering stops once no center moves by more than this
+	/// distance in an iteration. With 0 it runs until the labels stop changing.
+	double tolerance;
+
+	/// \brief Number of points drawn per iteration in mini-batch mode. With 0
+	/// (the default) every iteration uses all the points.
+	size_t batchSize;
+
+	/// \brief Seed of the k-means++ initialisation and of the mini-batches;
+	/// the same seed gives the same result regardless of the number of threads.
+	unsigned long long seed;
+};
+
+/// \brief Splits 'num' points into 'k' clusters minimising the sum of squared
+/// distances to the cluster centers (k-means).
+///
+/// The centers start from a k-means++ seeding. Full iterations use Hamerly's
+/// algorithm: distance bounds kept per point skip most point to center
+/// distances once the centers settle, and give the same result as Lloyd's
+/// iterations. When settings.batchSize is not 0, the centers are instead
+/// moved by random mini-batches (Sculley), much faster on large inputs for a
+/// slightly higher error. Assignments run in parallel.
+///
+/// A center losing all its points stays where it is. When 'k' is larger than
+/// 'num', only 'num' centers are returned.
+///
+/// \param centers Receives the cluster centers.
+/// \param labels Receives the index of the center of every point.
+/// \returns The sum of the squared distances from the points to their center.
+double ofKMeans( const ofVec2d* points, size_t num, int k, const ofKMeansSettings& settings,
+				std::vector<ofVec2d>& centers, std::vector<int>& labels );
+
+/// \brief ofKMeans() for ofVec3d, such as positions or RGB colours.
+double ofKMeans( const ofVec3d* points, size_t num, int k, const ofKMeansSettings& settings,
+				std::vector<ofVec3d>& centers, std::vector<int>& labels );
+
+/// \brief ofKMeans() for ofVec4d, such as RGBA colours.
+double ofKMeans( const ofVec4d* points, size_t num, int k, const ofKMeansSettings& settings,
+				std::vector<ofVec4d>& centers, std::vector<int>& labels );
@@ -0,0 +1,199 @@
+#include "ofKdTree3d.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace {
+
+// ranges smaller than this are never split across threads
+const size_t KDTREE_MIN_PARALLEL = 65536;
+
+}
+
+
+ofKdTree3d::ofKdTree3d()
+:leafSize(16) {}
+
+void ofKdTree3d::clear() {
+	nodes.clear();
+	points.clear();
+	pointIndices.clear();
+	positions.clear();
+}
+
+size_t ofKdTree3d::size() const {
+	return points.size();
+}
+
+const ofVec3d& ofKdTree3d::getPoint( size_t index ) const {
+	return points[positions[index]];
+}
+
+void ofKdTree3d::build( const ofVec3d* _points, size_t num, size_t _leafSize ) {
+	clear();
+	leafSize = _leafSize > 0 ? _leafSize : 1;
+	if( _points == NULL || num == 0 ) {
+		return;
+	}
+
+	// the tree is implicit: node n has children 2n+1 and 2n+2
+	int depth = 0;
+	while( ((num + ((size_t)1 << depth) - 1) >> depth) > leafSize ) {
+		depth++;
+	}
+	nodes.resize( ((size_t)1 << (depth + 1)) - 1 );
+
+	pointIndices.resize( num );
+	for( size_t i=0; i<num; i++ ) {
+		pointIndices[i] = i;
+	}
+	// build() reads the caller's points, the copy is made afterwards in tree order
+	points.assign( _points, _points + num );
+
+	int parallelDepth = 0;
+	while( ((size_t)1 << parallelDepth) < ofGetVecXdNumThreads() ) {
+		parallelDepth++;
+	}
+	buildNode( 0, 0, num, 0, parallelDepth );
+
+	std::vector<ofVec3d> ordered( num );
+	positions.resize( num );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			ordered[i] = _points[pointIndices[i]];
+			positions[pointIndices[i]] = i;
+		}
+	});
+	points.swap( ordered );
+}
+
+void ofKdTree3d::buildNode( size_t node, size_t begin, size_t end, int depth, int parallelDepth ) {
+	if( end - begin <= leafSize ) {
+		return;
+	}
+	ofVec3d minimum( DBL_MAX ), maximum( -DBL_MAX );
+	for( size_t i=begin; i<end; i++ ) {
+		const ofVec3d& p = points[pointIndices[i]];
+		minimum.x = MIN( minimum.x, p.x ); maximum.x = MAX( maximum.x, p.x );
+		minimum.y = MIN( minimum.y, p.y ); maximum.y = MAX( maximum.y, p.y );
+		minimum.z = MIN( minimum.z, p.z ); maximum.z = MAX( maximum.z, p.z );
+	}
+	ofVec3d extent = maximum - minimum;
+	int axis = 0;
+	if( extent.y > extent[axis] ) axis = 1;
+	if( extent.z > extent[axis] ) axis = 2;
+
+	size_t mid = begin + (end - begin) / 2;
+	const std::vector<ofVec3d>& pts = points;
+	std::nth_element( pointIndices.begin() + begin, pointIndices.begin() + mid, pointIndices.begin() + end,
+					 [&]( size_t a, size_t b ) { return pts[a][axis] < pts[b][axis]; });
+	nodes[node].axis = axis;
+	nodes[node].split = points[pointIndices[mid]][axis];
+
+	if( depth < parallelDepth && end - begin >= KDTREE_MIN_PARALLEL ) {
+		std::thread right( &ofKdTree3d::buildNode, this, 2*node + 2, mid, end, depth + 1, parallelDepth );
+		buildNode( 2*node + 1, begin, mid, depth + 1, parallelDepth );
+		right.join();
+	} else {
+		buildNode( 2*node + 1, begin, mid, depth + 1, parallelDepth );
+		buildNode( 2*node + 2, mid, end, depth + 1, parallelDepth );
+	}
+}
+
+size_t ofKdTree3d::findNearest( const ofVec3d& query, size_t k, size_t* indices, double* distancesSquared ) const {
+	if( k == 0 || points.empty() ) {
+		return 0;
+	}
+	if( k > points.size() ) {
+		k = points.size();
+	}
+	// sorted list of the best candidates so far, positions in tree order
+	std::vector<double> scratch;
+	double stackDistances[64];
+	double* heapDistances = stackDistances;
+	if( k > 64 ) {
+		scratch.resize( k );
+		heapDistances = &scratch[0];
+	}
+	size_t heapSize = 0;
+	nearest( 0, 0, points.size(), query, k, indices, heapDistances, heapSize );
+	for( size_t i=0; i<heapSize; i++ ) {
+		indices[i] = pointIndices[indices[i]];
+		if( distancesSquared ) {
+			distancesSquared[i] = heapDistances[i];
+		}
+	}
+	return heapSize;
+}
+
+void ofKdTree3d::nearest( size_t node, size_t begin, size_t end, const ofVec3d& query, size_t k,
+						 size_t* heapIndices, double* heapDistances, size_t& heapSize ) const {
+	if( end - begin <= leafSize ) {
+		for( size_t i=begin; i<end; i++ ) {
+			double d2 = points[i].squareDistance( query );
+			if( heapSize == k && d2 >= heapDistances[k-1] ) {
+				continue;
+			}
+			size_t j = heapSize < k ? heapSize++ : k - 1;
+			while( j > 0 && heapDistances[j-1] > d2 ) {
+				heapDistances[j] = heapDistances[j-1];
+				heapIndices[j] = heapIndices[j-1];
+				j--;
+			}
+			heapDistances[j] = d2;
+			heapIndices[j] = i;
+		}
+		return;
+	}
+	size_t mid = begin + (end - begin) / 2;
+	double diff = query[nodes[node].axis] - nodes[node].split;
+	if( diff < 0 ) {
+		nearest( 2*node + 1, begin, mid, query, k, heapIndices, heapDistances, heapSize );
+		if( heapSize < k || diff*diff < heapDistances[k-1] ) {
+			nearest( 2*node + 2, mid, end, query, k, heapIndices, heapDistances, heapSize );
+		}
+	} else {
+		nearest( 2*node + 2, mid, end, query, k, heapIndices, heapDistances, heapSize );
+		if( heapSize < k || diff*diff < heapDistances[k-1] ) {
+			nearest( 2*node + 1, begin, mid, query, k, heapIndices, heapDistances, heapSize );
+		}
+	}
+}
+
+size_t ofKdTree3d::findWithinRadius( const ofVec3d& query, double radius, std::vector<size_t>& indices,
+									std::vector<double>* distancesSquared ) const {
+	indices.clear();
+	if( distancesSquared ) {
+		distancesSquared->clear();
+	}
+	if( points.empty() || radius < 0 ) {
+		return 0;
+	}
+	withinRadius( 0, 0, points.size(), query, radius*radius, indices, distancesSquared );
+	return indices.size();
+}
+
+void ofKdTree3d::withinRadius( size_t node, size_t begin, size_t end, const ofVec3d& query, double radius2,
+							  std::vector<size_t>& indices, std::vector<double>* distancesSquared ) const {
+	if( end - begin <= leafSize ) {
+		for( size_t i=begin; i<end; i++ ) {
+			double d2 = points[i].squareDistance( query );
+			if( d2 < radius2 ) {
+				indices.push_back( pointIndices[i] );
+				if( distancesSquared ) {
+					distancesSquared->push_back( d2 );
+				}
+			}
+		}
+		return;
+	}
+	size_t mid = begin + (end - begin) / 2;
+	double diff = query[nodes[node].axis] - nodes[node].split;
+	if( diff < 0 || diff*diff < radius2 ) {
+		withinRadius( 2*node + 1, begin, mid, query, radius2, indices, distancesSquared );
+	}
+	if( diff >= 0 || diff*diff < radius2 ) {
+		withinRadius( 2*node + 2, mid, end, query, radius2, indices, distancesSquared );
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief ofKdTree3d is a static k-d tree over an array of ofVec3d for
+/// nearest neighbour and radius queries.
+///
+/// The tree is balanced and implicit: every split halves its range, so nodes
+/// live in one flat array without child pointers and the two halves of the
+/// top levels are built on separate threads. The points are copied in tree
+/// order so that the leaves visited by a query are contiguous in memory.
+///
+/// Queries are const and can run concurrently from many threads.
+///
+/// ~~~~{.cpp}
+/// ofKdTree3d tree;
+/// tree.build(cloud.data(), cloud.size());
+/// size_t indices[8];
+/// double distances[8];
+/// size_t found = tree.findNearest(ofVec3d(0, 0, 0), 8, indices, distances);
+/// ~~~~
+class ofKdTree3d {
+public:
+	ofKdTree3d();
+
+	/// \brief Builds the tree over 'num' points. The points are copied.
+	///
+	/// \param leafSize The largest number of points stored in a leaf.
+	void build( const ofVec3d* points, size_t num, size_t leafSize = 16 );
+
+	/// \brief Removes all the points.
+	void clear();
+
+	/// \brief Returns the number of points in the tree.
+	size_t size() const;
+
+	/// \brief Returns point 'index', in the order the points were given to build().
+	const ofVec3d& getPoint( size_t index ) const;
+
+	/// \brief Finds the 'k' points closest to 'query'.
+	///
+	/// \param indices Receives up to 'k' point indices, closest first.
+	/// \param distancesSquared Optional, receives the matching squared distances.
+	/// \returns The number of points found, 'k' unless the tree is smaller.
+	size_t findNearest( const ofVec3d& query, size_t k, size_t* indices, double* distancesSquared = NULL ) const;
+
+	/// \brief Finds all the points closer than 'radius' to 'query', in no particular order.
+	///
+	/// \param indices Cleared, then receives the point indices.
+	/// \param distancesSquared Optional, cleared then receives the matching squared distances.
+	/// \returns The number of points found.
+	size_t findWithinRadius( const ofVec3d& query, double radius, std::vector<size_t>& indices,
+							std::vector<double>* distancesSquared = NULL ) const;
+
+private:
+	struct Node {
+		double split;
+		int axis;
+	};
+
+	void buildNode( size_t node, size_t begin, size_t end, int depth, int parallelDepth );
+	void nearest( size_t node, size_t begin, size_t end, const ofVec3d& query, size_t k,
+				 size_t* heapIndices, double* heapDistances, size_t& heapSize ) const;
+	void withinRadius( size_t node, size_t begin, size_t end, const ofVec3d& query, double radius2,
+					  std::vector<size_t>& indices, std::vector<double>* distancesSquared ) const;
+
+	std::vector<Node> nodes;
+	std::vector<ofVec3d> points;
+	std::vector<size_t> pointIndices;
+	std::vector<size_t> positions;
+	size_t leafSize;
+};
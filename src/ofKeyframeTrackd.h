@@ -0,0 +1,323 @@
+#pragma once
+
+#include "ofVec2d.h"
+#include "ofVec3d.h"
+#include "ofVec4d.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <vector>
+
+enum ofKeyframeInterpolation {
+	/// \brief Holds the value of the previous key until the next one.
+	OF_KEYFRAME_STEP,
+	/// \brief Linear interpolation between the surrounding keys.
+	OF_KEYFRAME_LINEAR
+};
+
+/// \brief ofKeyframeTrack_ animates an ofVec2d, ofVec3d or ofVec4d value
+/// over time from a list of keys. Use the ofKeyframeTrack2d, ofKeyframeTrack3d
+/// and ofKeyframeTrack4d typedefs.
+///
+/// The key times and every component of the values are stored in separate
+/// arrays. The track remembers the key found by the last call to sample(), so
+/// when the time moves forward or backward a little between calls, as it does
+/// during playback, finding the keys is constant time instead of a binary
+/// search. getValue() does not use the cursor and can be called from many
+/// threads at once.
+///
+/// ~~~~{.cpp}
+/// ofKeyframeTrack3d track;
+/// track.addKey(0.0, ofVec3d(0, 0, 0));
+/// track.addKey(1.5, ofVec3d(100, 0, 0));
+/// track.addKey(4.0, ofVec3d(100, 50, 0));
+/// // every frame
+/// node.setPosition(track.sample(ofGetElapsedTimef()));
+///
+/// // thousands of tracks at once
+/// ofSampleKeyframeTracks(tracks.data(), tracks.size(), time, positions.data());
+/// ~~~~
+template<class Vec>
+class ofKeyframeTrack_ {
+public:
+	ofKeyframeTrack_();
+
+	void setInterpolation( ofKeyframeInterpolation interpolation );
+	ofKeyframeInterpolation getInterpolation() const;
+
+	/// \brief Adds a key, keeping the keys sorted by time, and returns its index.
+	/// A key at the same time as an existing one is placed after it.
+	size_t addKey( double time, const Vec& value );
+
+	/// \brief Replaces the keys, 'times' must be sorted in increasing order.
+	void setKeys( const double* times, const Vec* values, size_t num );
+
+	void removeKey( size_t index );
+	void clear();
+
+	size_t getNumKeys() const;
+	double getKeyTime( size_t index ) const;
+	Vec getKeyValue( size_t index ) const;
+	void setKeyValue( size_t index, const Vec& value );
+
+	/// \brief Returns the time of the first key, 0 without keys.
+	double getStartTime() const;
+
+	/// \brief Returns the time of the last key, 0 without keys.
+	double getEndTime() const;
+
+	/// \brief Returns the value at 'time', found from the key of the last call.
+	/// Before the first key the first value is returned, after the last key the last one.
+	Vec sample( double time );
+
+	/// \brief Returns the value at 'time' with a binary search.
+	Vec getValue( double time ) const;
+
+	/// \brief Finds the key before 'time' from the cursor and the interpolation
+	/// factor towards the next key, used by sample() and ofSampleKeyframeTracks().
+	size_t seek( double time, double& fraction );
+
+private:
+	size_t findKey( double time, size_t hint ) const;
+	double getFraction( size_t key, double time ) const;
+	Vec interpolate( size_t key, double fraction ) const;
+
+	ofKeyframeInterpolation interpolation;
+	std::vector<double> times;
+	std::vector<double> values[Vec::DIM];
+	size_t cursor;
+};
+
+typedef ofKeyframeTrack_<ofVec2d> ofKeyframeTrack2d;
+typedef ofKeyframeTrack_<ofVec3d> ofKeyframeTrack3d;
+typedef ofKeyframeTrack_<ofVec4d> ofKeyframeTrack4d;
+
+/// \brief Samples 'num' tracks at the same 'time' into 'out', using and
+/// updating the cursor of every track.
+///
+/// The keys of every track are found first, then the values are interpolated
+/// one component at a time over all the tracks. Large batches are split
+/// across threads.
+template<class Vec>
+void ofSampleKeyframeTracks( ofKeyframeTrack_<Vec>* tracks, size_t num, double time, Vec* out );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+/// \cond INTERNAL
+// smallest number of tracks worth a thread
+static const size_t OF_KEYFRAME_MIN_CHUNK = 2048;
+
+// keys the cursor walks before falling back to a binary search
+static const size_t OF_KEYFRAME_MAX_STEPS = 4;
+/// \endcond
+
+template<class Vec>
+inline ofKeyframeTrack_<Vec>::ofKeyframeTrack_()
+:interpolation(OF_KEYFRAME_LINEAR)
+,cursor(0) {}
+
+template<class Vec>
+inline void ofKeyframeTrack_<Vec>::setInterpolation( ofKeyframeInterpolation _interpolation ) {
+	interpolation = _interpolation;
+}
+
+template<class Vec>
+inline ofKeyframeInterpolation ofKeyframeTrack_<Vec>::getInterpolation() const {
+	return interpolation;
+}
+
+template<class Vec>
+inline size_t ofKeyframeTrack_<Vec>::addKey( double time, const Vec& value ) {
+	size_t index = std::upper_bound( times.begin(), times.end(), time ) - times.begin();
+	times.insert( times.begin() + index, time );
+	for( int c=0; c<Vec::DIM; c++ ) {
+		values[c].insert( values[c].begin() + index, value[c] );
+	}
+	cursor = 0;
+	return index;
+}
+
+template<class Vec>
+inline void ofKeyframeTrack_<Vec>::setKeys( const double* _times, const Vec* _values, size_t num ) {
+	times.assign( _times, _times + num );
+	for( int c=0; c<Vec::DIM; c++ ) {
+		values[c].resize( num );
+		for( size_t i=0; i<num; i++ ) {
+			values[c][i] = _values[i][c];
+		}
+	}
+	cursor = 0;
+}
+
+template<class Vec>
+inline void ofKeyframeTrack_<Vec>::removeKey( size_t index ) {
+	times.erase( times.begin() + index );
+	for( int c=0; c<Vec::DIM; c++ ) {
+		values[c].erase( values[c].begin() + index );
+	}
+	cursor = 0;
+}
+
+template<class Vec>
+inline void ofKeyframeTrack_<Vec>::clear() {
+	times.clear();
+	for( int c=0; c<Vec::DIM; c++ ) {
+		values[c].clear();
+	}
+	cursor = 0;
+}
+
+template<class Vec>
+inline size_t ofKeyframeTrack_<Vec>::getNumKeys() const {
+	return times.size();
+}
+
+template<class Vec>
+inline double ofKeyframeTrack_<Vec>::getKeyTime( size_t index ) const {
+	return times[index];
+}
+
+template<class Vec>
+inline Vec ofKeyframeTrack_<Vec>::getKeyValue( size_t index ) const {
+	Vec v;
+	for( int c=0; c<Vec::DIM; c++ ) {
+		v[c] = values[c][index];
+	}
+	return v;
+}
+
+template<class Vec>
+inline void ofKeyframeTrack_<Vec>::setKeyValue( size_t index, const Vec& value ) {
+	for( int c=0; c<Vec::DIM; c++ ) {
+		values[c][index] = value[c];
+	}
+}
+
+template<class Vec>
+inline double ofKeyframeTrack_<Vec>::getStartTime() const {
+	return times.empty() ? 0.0 : times.front();
+}
+
+template<class Vec>
+inline double ofKeyframeTrack_<Vec>::getEndTime() const {
+	return times.empty() ? 0.0 : times.back();
+}
+
+// Returns the last key at or before 'time' (0 before the first key), walking
+// a few keys from 'hint' before falling back to a binary search.
+template<class Vec>
+inline size_t ofKeyframeTrack_<Vec>::findKey( double time, size_t hint ) const {
+	const size_t num = times.size();
+	size_t key = MIN( hint, num - 1 );
+	if( times[key] <= time ) {
+		for( size_t step=0; step<OF_KEYFRAME_MAX_STEPS; step++ ) {
+			if( key + 1 == num || times[key + 1] > time ) {
+				return key;
+			}
+			key++;
+		}
+	} else {
+		for( size_t step=0; step<OF_KEYFRAME_MAX_STEPS; step++ ) {
+			if( key == 0 ) {
+				return 0;
+			}
+			key--;
+			if( times[key] <= time ) {
+				return key;
+			}
+		}
+	}
+	size_t upper = std::upper_bound( times.begin(), times.end(), time ) - times.begin();
+	return upper > 0 ? upper - 1 : 0;
+}
+
+template<class Vec>
+inline double ofKeyframeTrack_<Vec>::getFraction( size_t key, double time ) const {
+	if( interpolation == OF_KEYFRAME_STEP || key + 1 >= times.size() || time <= times[key] ) {
+		return 0.0;
+	}
+	double span = times[key + 1] - times[key];
+	return span > 0 ? MIN( (time - times[key]) / span, 1.0 ) : 0.0;
+}
+
+template<class Vec>
+inline Vec ofKeyframeTrack_<Vec>::interpolate( size_t key, double fraction ) const {
+	const size_t next = MIN( key + 1, times.size() - 1 );
+	Vec v;
+	for( int c=0; c<Vec::DIM; c++ ) {
+		const double a = values[c][key];
+		v[c] = a + (values[c][next] - a) * fraction;
+	}
+	return v;
+}
+
+template<class Vec>
+inline size_t ofKeyframeTrack_<Vec>::seek( double time, double& fraction ) {
+	if( times.empty() ) {
+		fraction = 0;
+		return 0;
+	}
+	cursor = findKey( time, cursor );
+	fraction = getFraction( cursor, time );
+	return cursor;
+}
+
+template<class Vec>
+inline Vec ofKeyframeTrack_<Vec>::sample( double time ) {
+	if( times.empty() ) {
+		return Vec();
+	}
+	double fraction;
+	size_t key = seek( time, fraction );
+	return interpolate( key, fraction );
+}
+
+template<class Vec>
+inline Vec ofKeyframeTrack_<Vec>::getValue( double time ) const {
+	if( times.empty() ) {
+		return Vec();
+	}
+	size_t upper = std::upper_bound( times.begin(), times.end(), time ) - times.begin();
+	size_t key = upper > 0 ? upper - 1 : 0;
+	return interpolate( key, getFraction( key, time ) );
+}
+
+template<class Vec>
+inline void ofSampleKeyframeTracks( ofKeyframeTrack_<Vec>* tracks, size_t num, double time, Vec* out ) {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		const size_t count = end - begin;
+		// the surrounding key values of every track, then one interpolation loop per component
+		std::vector<double> fractions( count ), from( count * Vec::DIM ), to( count * Vec::DIM );
+		for( size_t i=0; i<count; i++ ) {
+			ofKeyframeTrack_<Vec>& track = tracks[begin + i];
+			const size_t numKeys = track.getNumKeys();
+			size_t key = track.seek( time, fractions[i] );
+			if( numKeys == 0 ) {
+				for( int c=0; c<Vec::DIM; c++ ) {
+					from[c * count + i] = to[c * count + i] = 0.0;
+				}
+				continue;
+			}
+			const size_t next = MIN( key + 1, numKeys - 1 );
+			Vec a = track.getKeyValue( key );
+			Vec b = track.getKeyValue( next );
+			for( int c=0; c<Vec::DIM; c++ ) {
+				from[c * count + i] = a[c];
+				to[c * count + i] = b[c];
+			}
+		}
+		for( int c=0; c<Vec::DIM; c++ ) {
+			const double* a = &from[c * count];
+			const double* b = &to[c * count];
+			const double* f = &fractions[0];
+			Vec* o = out + begin;
+			for( size_t i=0; i<count; i++ ) {
+				o[i][c] = a[i] + (b[i] - a[i]) * f[i];
+			}
+		}
+	}, OF_KEYFRAME_MIN_CHUNK );
+}
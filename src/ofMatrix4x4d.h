@@ -0,0 +1,259 @@
+#pragma once
+
+#include "ofVec3d.h"
+#include "ofQuaterniond.h"
+
+/// \brief ofMatrix4x4d is a double precision 4x4 transform, following the
+/// conventions of ofMatrix4x4.
+///
+/// Vectors are rows multiplied on the left, 'v * m', so 'a * b' is the
+/// transform 'a' followed by 'b'. getPtr() gives the 16 values in the order
+/// OpenGL expects, the translation in elements 12, 13 and 14, as read by
+/// ofMeshd::transform() and ofFrustumd::setFromMatrix().
+///
+/// ~~~~{.cpp}
+/// ofMatrix4x4d local;
+/// local.makeTransformMatrix(position, orientation, scale);
+/// ofMatrix4x4d global = local * parentGlobal;
+/// ofVec3d p = ofVec3d(1, 0, 0) * global;
+/// ~~~~
+class ofMatrix4x4d {
+public:
+	/// \brief The values, '_mat[3]' holding the translation.
+	double _mat[4][4];
+
+	/// \brief Builds the identity.
+	ofMatrix4x4d();
+	/// \brief Builds a matrix from 16 values stored like getPtr().
+	ofMatrix4x4d( const double* ptr );
+
+	void set( const double* ptr );
+	double* getPtr();
+	const double* getPtr() const;
+
+	double& operator()( int row, int col );
+	double operator()( int row, int col ) const;
+
+	void makeIdentityMatrix();
+	void makeTranslationMatrix( const ofVec3d& translation );
+	void makeScaleMatrix( const ofVec3d& scale );
+	void makeRotationMatrix( const ofQuaterniond& rotation );
+
+	/// \brief Makes the transform scaling by 'scale', then rotating by
+	/// 'rotation', then translating by 'translation', as ofNode does.
+	void makeTransformMatrix( const ofVec3d& translation, const ofQuaterniond& rotation, const ofVec3d& scale );
+
+	/// \brief Makes the inverse of 'm'. Returns false, leaving this matrix
+	/// unchanged, if 'm' is singular.
+	bool makeInvertOf( const ofMatrix4x4d& m );
+	ofMatrix4x4d getInverse() const;
+
+	ofVec3d getTranslation() const;
+	void setTranslation( const ofVec3d& translation );
+
+	/// \brief Returns the transform of this matrix followed by 'm'.
+	ofMatrix4x4d operator*( const ofMatrix4x4d& m ) const;
+	ofMatrix4x4d& operator*=( const ofMatrix4x4d& m );
+
+	/// \brief Returns 'v * m', the point 'v' transformed, divided by w.
+	ofVec3d preMult( const ofVec3d& v ) const;
+	/// \brief Returns 'm * v', with 'v' as a column vector, divided by w.
+	ofVec3d postMult( const ofVec3d& v ) const;
+
+	/// \brief Returns the direction 'v' transformed, without the translation.
+	ofVec3d transform3x3( const ofVec3d& v ) const;
+};
+
+/// \brief Returns the point 'v' transformed by 'm'.
+ofVec3d operator*( const ofVec3d& v, const ofMatrix4x4d& m );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofMatrix4x4d::ofMatrix4x4d() {
+	makeIdentityMatrix();
+}
+
+inline ofMatrix4x4d::ofMatrix4x4d( const double* ptr ) {
+	set( ptr );
+}
+
+inline void ofMatrix4x4d::set( const double* ptr ) {
+	for( int i=0; i<16; i++ ) {
+		_mat[i / 4][i % 4] = ptr[i];
+	}
+}
+
+inline double* ofMatrix4x4d::getPtr() {
+	return &_mat[0][0];
+}
+
+inline const double* ofMatrix4x4d::getPtr() const {
+	return &_mat[0][0];
+}
+
+inline double& ofMatrix4x4d::operator()( int row, int col ) {
+	return _mat[row][col];
+}
+
+inline double ofMatrix4x4d::operator()( int row, int col ) const {
+	return _mat[row][col];
+}
+
+
+// Builders.
+//
+//
+inline void ofMatrix4x4d::makeIdentityMatrix() {
+	for( int r=0; r<4; r++ ) {
+		for( int c=0; c<4; c++ ) {
+			_mat[r][c] = r == c ? 1.0 : 0.0;
+		}
+	}
+}
+
+inline void ofMatrix4x4d::makeTranslationMatrix( const ofVec3d& translation ) {
+	makeIdentityMatrix();
+	setTranslation( translation );
+}
+
+inline void ofMatrix4x4d::makeScaleMatrix( const ofVec3d& scale ) {
+	makeTransformMatrix( ofVec3d( 0, 0, 0 ), ofQuaterniond(), scale );
+}
+
+inline void ofMatrix4x4d::makeRotationMatrix( const ofQuaterniond& rotation ) {
+	makeTransformMatrix( ofVec3d( 0, 0, 0 ), rotation, ofVec3d( 1, 1, 1 ) );
+}
+
+inline void ofMatrix4x4d::makeTransformMatrix( const ofVec3d& translation, const ofQuaterniond& q, const ofVec3d& scale ) {
+	const double xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	const double xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	const double wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	// row i is the image of axis i: scaled, then rotated
+	_mat[0][0] = scale.x * (1.0 - 2.0 * (yy + zz));
+	_mat[0][1] = scale.x * 2.0 * (xy + wz);
+	_mat[0][2] = scale.x * 2.0 * (xz - wy);
+	_mat[0][3] = 0;
+	_mat[1][0] = scale.y * 2.0 * (xy - wz);
+	_mat[1][1] = scale.y * (1.0 - 2.0 * (xx + zz));
+	_mat[1][2] = scale.y * 2.0 * (yz + wx);
+	_mat[1][3] = 0;
+	_mat[2][0] = scale.z * 2.0 * (xz + wy);
+	_mat[2][1] = scale.z * 2.0 * (yz - wx);
+	_mat[2][2] = scale.z * (1.0 - 2.0 * (xx + yy));
+	_mat[2][3] = 0;
+	_mat[3][0] = translation.x;
+	_mat[3][1] = translation.y;
+	_mat[3][2] = translation.z;
+	_mat[3][3] = 1;
+}
+
+inline bool ofMatrix4x4d::makeInvertOf( const ofMatrix4x4d& m ) {
+	// Gauss-Jordan elimination with partial pivoting
+	double a[4][8];
+	for( int r=0; r<4; r++ ) {
+		for( int c=0; c<4; c++ ) {
+			a[r][c] = m._mat[r][c];
+			a[r][c + 4] = r == c ? 1.0 : 0.0;
+		}
+	}
+	for( int col=0; col<4; col++ ) {
+		int pivot = col;
+		for( int r=col+1; r<4; r++ ) {
+			if( fabs( a[r][col] ) > fabs( a[pivot][col] ) ) {
+				pivot = r;
+			}
+		}
+		if( fabs( a[pivot][col] ) < 1e-300 ) {
+			return false;
+		}
+		if( pivot != col ) {
+			for( int c=0; c<8; c++ ) {
+				double tmp = a[col][c];
+				a[col][c] = a[pivot][c];
+				a[pivot][c] = tmp;
+			}
+		}
+		const double inv = 1.0 / a[col][col];
+		for( int c=0; c<8; c++ ) {
+			a[col][c] *= inv;
+		}
+		for( int r=0; r<4; r++ ) {
+			if( r != col && a[r][col] != 0 ) {
+				const double f = a[r][col];
+				for( int c=0; c<8; c++ ) {
+					a[r][c] -= f * a[col][c];
+				}
+			}
+		}
+	}
+	for( int r=0; r<4; r++ ) {
+		for( int c=0; c<4; c++ ) {
+			_mat[r][c] = a[r][c + 4];
+		}
+	}
+	return true;
+}
+
+inline ofMatrix4x4d ofMatrix4x4d::getInverse() const {
+	ofMatrix4x4d inverse;
+	inverse.makeInvertOf( *this );
+	return inverse;
+}
+
+inline ofVec3d ofMatrix4x4d::getTranslation() const {
+	return ofVec3d( _mat[3][0], _mat[3][1], _mat[3][2] );
+}
+
+inline void ofMatrix4x4d::setTranslation( const ofVec3d& translation ) {
+	_mat[3][0] = translation.x;
+	_mat[3][1] = translation.y;
+	_mat[3][2] = translation.z;
+}
+
+
+// Products.
+//
+//
+inline ofMatrix4x4d ofMatrix4x4d::operator*( const ofMatrix4x4d& m ) const {
+	ofMatrix4x4d out;
+	for( int r=0; r<4; r++ ) {
+		for( int c=0; c<4; c++ ) {
+			out._mat[r][c] = _mat[r][0] * m._mat[0][c] + _mat[r][1] * m._mat[1][c]
+			+ _mat[r][2] * m._mat[2][c] + _mat[r][3] * m._mat[3][c];
+		}
+	}
+	return out;
+}
+
+inline ofMatrix4x4d& ofMatrix4x4d::operator*=( const ofMatrix4x4d& m ) {
+	*this = *this * m;
+	return *this;
+}
+
+inline ofVec3d ofMatrix4x4d::preMult( const ofVec3d& v ) const {
+	const double d = 1.0 / (_mat[0][3] * v.x + _mat[1][3] * v.y + _mat[2][3] * v.z + _mat[3][3]);
+	return ofVec3d( (_mat[0][0] * v.x + _mat[1][0] * v.y + _mat[2][0] * v.z + _mat[3][0]) * d,
+				   (_mat[0][1] * v.x + _mat[1][1] * v.y + _mat[2][1] * v.z + _mat[3][1]) * d,
+				   (_mat[0][2] * v.x + _mat[1][2] * v.y + _mat[2][2] * v.z + _mat[3][2]) * d );
+}
+
+inline ofVec3d ofMatrix4x4d::postMult( const ofVec3d& v ) const {
+	const double d = 1.0 / (_mat[3][0] * v.x + _mat[3][1] * v.y + _mat[3][2] * v.z + _mat[3][3]);
+	return ofVec3d( (_mat[0][0] * v.x + _mat[0][1] * v.y + _mat[0][2] * v.z + _mat[0][3]) * d,
+				   (_mat[1][0] * v.x + _mat[1][1] * v.y + _mat[1][2] * v.z + _mat[1][3]) * d,
+				   (_mat[2][0] * v.x + _mat[2][1] * v.y + _mat[2][2] * v.z + _mat[2][3]) * d );
+}
+
+inline ofVec3d ofMatrix4x4d::transform3x3( const ofVec3d& v ) const {
+	return ofVec3d( _mat[0][0] * v.x + _mat[1][0] * v.y + _mat[2][0] * v.z,
+				   _mat[0][1] * v.x + _mat[1][1] * v.y + _mat[2][1] * v.z,
+				   _mat[0][2] * v.x + _mat[1][2] * v.y + _mat[2][2] * v.z );
+}
+
+inline ofVec3d operator*( const ofVec3d& v, const ofMatrix4x4d& m ) {
+	return m.preMult( v );
+}
@@ -0,0 +1,103 @@
+#include "ofMeshNormalsd.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of triangles or vertices worth a thread
+const size_t MESH_NORMALS_MIN_CHUNK = 8192;
+
+inline double cornerAngle( const ofVec3d& e0, const ofVec3d& e1 ) {
+	// atan2 of |cross| and dot stays accurate for very thin triangles, unlike acos
+	return atan2( e0.getCrossed(e1).length(), e0.dot(e1) );
+}
+
+}
+
+
+void ofVertexFaceAdjacency::build( const unsigned int* indices, size_t numTriangles, size_t numVertices ) {
+	offsets.assign( numVertices + 1, 0 );
+	corners.resize( numTriangles * 3 );
+	for( size_t c=0; c<numTriangles * 3; c++ ) {
+		offsets[indices[c] + 1]++;
+	}
+	for( size_t v=0; v<numVertices; v++ ) {
+		offsets[v + 1] += offsets[v];
+	}
+	std::vector<unsigned int> cursor( offsets.begin(), offsets.end() - 1 );
+	for( size_t c=0; c<numTriangles * 3; c++ ) {
+		corners[cursor[indices[c]]++] = (unsigned int)c;
+	}
+}
+
+void ofComputeFaceNormals( const ofVec3d* positions, const unsigned int* indices, size_t numTriangles,
+						  ofVec3d* faceNormals, bool normalize ) {
+	ofParallelFor( 0, numTriangles, [&]( size_t begin, size_t end ) {
+		for( size_t t=begin; t<end; t++ ) {
+			const ofVec3d& a = positions[indices[t*3 + 0]];
+			const ofVec3d& b = positions[indices[t*3 + 1]];
+			const ofVec3d& c = positions[indices[t*3 + 2]];
+			double e1x = b.x - a.x, e1y = b.y - a.y, e1z = b.z - a.z;
+			double e2x = c.x - a.x, e2y = c.y - a.y, e2z = c.z - a.z;
+			double nx = e1y*e2z - e1z*e2y;
+			double ny = e1z*e2x - e1x*e2z;
+			double nz = e1x*e2y - e1y*e2x;
+			if( normalize ) {
+				double len2 = nx*nx + ny*ny + nz*nz;
+				double inv = len2 > 0 ? 1.0 / sqrt( len2 ) : 0.0;
+				nx *= inv;
+				ny *= inv;
+				nz *= inv;
+			}
+			faceNormals[t].set( nx, ny, nz );
+		}
+	}, MESH_NORMALS_MIN_CHUNK );
+}
+
+void ofComputeVertexNormals( const ofVec3d* positions, size_t numVertices,
+							const unsigned int* indices, size_t numTriangles,
+							const ofVertexFaceAdjacency& adjacency, ofVec3d* normals,
+							ofNormalWeighting weighting ) {
+	if( numVertices == 0 ) {
+		return;
+	}
+
+	// area weighting sums the raw cross products, their length is twice the area
+	std::vector<ofVec3d> faceNormals( numTriangles );
+	ofComputeFaceNormals( positions, indices, numTriangles, faceNormals.data(),
+						 weighting != OF_NORMAL_WEIGHT_AREA );
+
+	std::vector<double> angles;
+	if( weighting == OF_NORMAL_WEIGHT_ANGLE ) {
+		angles.resize( numTriangles * 3 );
+		ofParallelFor( 0, numTriangles, [&]( size_t begin, size_t end ) {
+			for( size_t t=begin; t<end; t++ ) {
+				const ofVec3d& a = positions[indices[t*3 + 0]];
+				const ofVec3d& b = positions[indices[t*3 + 1]];
+				const ofVec3d& c = positions[indices[t*3 + 2]];
+				angles[t*3 + 0] = cornerAngle( b - a, c - a );
+				angles[t*3 + 1] = cornerAngle( c - b, a - b );
+				angles[t*3 + 2] = cornerAngle( a - c, b - c );
+			}
+		}, MESH_NORMALS_MIN_CHUNK );
+	}
+
+	// every vertex gathers its own faces, no two threads write the same normal
+	ofParallelFor( 0, numVertices, [&]( size_t begin, size_t end ) {
+		for( size_t v=begin; v<end; v++ ) {
+			double nx = 0, ny = 0, nz = 0;
+			unsigned int first = adjacency.offsets[v];
+			unsigned int last = adjacency.offsets[v + 1];
+			for( unsigned int k=first; k<last; k++ ) {
+				unsigned int corner = adjacency.corners[k];
+				const ofVec3d& n = faceNormals[corner / 3];
+				double w = weighting == OF_NORMAL_WEIGHT_ANGLE ? angles[corner] : 1.0;
+				nx += n.x * w;
+				ny += n.y * w;
+				nz += n.z * w;
+			}
+			double len2 = nx*nx + ny*ny + nz*nz;
+			double inv = len2 > 0 ? 1.0 / sqrt( len2 ) : 0.0;
+			normals[v].set( nx*inv, ny*inv, nz*inv );
+		}
+	}, MESH_NORMALS_MIN_CHUNK );
+}
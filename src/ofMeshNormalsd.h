@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief How the normals of the faces around a vertex are averaged.
+enum ofNormalWeighting {
+	/// \brief Every face counts the same.
+	OF_NORMAL_WEIGHT_UNIFORM,
+	/// \brief Faces are weighted by their area.
+	OF_NORMAL_WEIGHT_AREA,
+	/// \brief Faces are weighted by their angle at the vertex.
+	OF_NORMAL_WEIGHT_ANGLE
+};
+
+/// \brief ofVertexFaceAdjacency lists the triangles around each vertex of an
+/// indexed triangle mesh.
+///
+/// It only depends on the topology, so a deforming mesh builds it once and
+/// reuses it every frame. The corners of vertex 'v' are
+/// 'corners[offsets[v]]' to 'corners[offsets[v+1]-1]', each one being
+/// 'triangle * 3 + corner'.
+struct ofVertexFaceAdjacency {
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> corners;
+
+	/// \brief Builds the adjacency of 'numTriangles' triangles indexing 'numVertices' vertices.
+	void build( const unsigned int* indices, size_t numTriangles, size_t numVertices );
+};
+
+/// \brief Computes the normal of every triangle of an indexed mesh.
+///
+/// \param positions The vertex positions.
+/// \param indices Three vertex indices per triangle, counter clockwise.
+/// \param numTriangles The number of triangles.
+/// \param faceNormals Preallocated array receiving 'numTriangles' normals.
+/// \param normalize When false the normals are left with a length of twice
+/// the triangle area.
+void ofComputeFaceNormals( const ofVec3d* positions, const unsigned int* indices, size_t numTriangles,
+						  ofVec3d* faceNormals, bool normalize = true );
+
+/// \brief Computes the normal of every vertex of an indexed mesh.
+///
+/// Face normals are computed first in parallel, then every vertex gathers the
+/// faces listed in 'adjacency'. As no two threads write the same vertex there
+/// is no scatter and no atomics, and the result does not depend on the
+/// number of threads.
+///
+/// ~~~~{.cpp}
+/// ofVertexFaceAdjacency adjacency;
+/// adjacency.build(indices.data(), indices.size() / 3, positions.size());
+/// // every frame
+/// ofComputeVertexNormals(positions.data(), positions.size(), indices.data(), indices.size() / 3,
+///                        adjacency, normals.data(), OF_NORMAL_WEIGHT_ANGLE);
+/// ~~~~
+///
+/// \param normals Preallocated array receiving 'numVertices' unit normals.
+/// Vertices not used by any triangle get a zero normal.
+void ofComputeVertexNormals( const ofVec3d* positions, size_t numVertices,
+							const unsigned int* indices, size_t numTriangles,
+							const ofVertexFaceAdjacency& adjacency, ofVec3d* normals,
+							ofNormalWeighting weighting = OF_NORMAL_WEIGHT_AREA );
@@ -0,0 +1,290 @@
+#include "ofMeshd.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of vertices worth a thread
+const size_t MESH_MIN_CHUNK = 16384;
+
+}
+
+
+ofMeshd::ofMeshd()
+:adjacencyDirty(true) {}
+
+void ofMeshd::reserve( size_t numVertices, size_t numIndices, bool withNormals, bool withTexCoords ) {
+	vertices.reserve( numVertices );
+	if( withNormals ) {
+		normals.reserve( numVertices );
+	}
+	if( withTexCoords ) {
+		texCoords.reserve( numVertices );
+	}
+	indices.reserve( numIndices );
+}
+
+void ofMeshd::clear() {
+	vertices.clear();
+	normals.clear();
+	texCoords.clear();
+	indices.clear();
+	adjacencyDirty = true;
+}
+
+
+// Vertices and attributes.
+//
+//
+void ofMeshd::addVertex( const ofVec3d& v ) {
+	vertices.push_back( v );
+}
+
+void ofMeshd::addVertices( const ofVec3d* verts, size_t num ) {
+	vertices.insert( vertices.end(), verts, verts + num );
+}
+
+void ofMeshd::addNormal( const ofVec3d& n ) {
+	normals.push_back( n );
+}
+
+void ofMeshd::addNormals( const ofVec3d* n, size_t num ) {
+	normals.insert( normals.end(), n, n + num );
+}
+
+void ofMeshd::addTexCoord( const ofVec2d& t ) {
+	texCoords.push_back( t );
+}
+
+void ofMeshd::addTexCoords( const ofVec2d* t, size_t num ) {
+	texCoords.insert( texCoords.end(), t, t + num );
+}
+
+size_t ofMeshd::getNumVertices() const {
+	return vertices.size();
+}
+
+bool ofMeshd::hasNormals() const {
+	return !vertices.empty() && normals.size() == vertices.size();
+}
+
+bool ofMeshd::hasTexCoords() const {
+	return !vertices.empty() && texCoords.size() == vertices.size();
+}
+
+std::vector<ofVec3d>& ofMeshd::getVertices() {
+	return vertices;
+}
+
+const std::vector<ofVec3d>& ofMeshd::getVertices() const {
+	return vertices;
+}
+
+std::vector<ofVec3d>& ofMeshd::getNormals() {
+	return normals;
+}
+
+const std::vector<ofVec3d>& ofMeshd::getNormals() const {
+	return normals;
+}
+
+std::vector<ofVec2d>& ofMeshd::getTexCoords() {
+	return texCoords;
+}
+
+const std::vector<ofVec2d>& ofMeshd::getTexCoords() const {
+	return texCoords;
+}
+
+
+// Indices.
+//
+//
+void ofMeshd::addIndex( unsigned int i ) {
+	indices.push_back( i );
+	adjacencyDirty = true;
+}
+
+void ofMeshd::addIndices( const unsigned int* idx, size_t num ) {
+	indices.insert( indices.end(), idx, idx + num );
+	adjacencyDirty = true;
+}
+
+void ofMeshd::addTriangle( unsigned int a, unsigned int b, unsigned int c ) {
+	indices.push_back( a );
+	indices.push_back( b );
+	indices.push_back( c );
+	adjacencyDirty = true;
+}
+
+size_t ofMeshd::getNumIndices() const {
+	return indices.size();
+}
+
+std::vector<unsigned int>& ofMeshd::getIndices() {
+	return indices;
+}
+
+const std::vector<unsigned int>& ofMeshd::getIndices() const {
+	return indices;
+}
+
+void ofMeshd::indicesChanged() {
+	adjacencyDirty = true;
+}
+
+
+// Batch transforms.
+//
+//
+void ofMeshd::translate( const ofVec3d& offset ) {
+	ofParallelFor( 0, vertices.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			vertices[i] += offset;
+		}
+	}, MESH_MIN_CHUNK );
+}
+
+void ofMeshd::scale( const ofVec3d& factor ) {
+	double matrix[16] = {
+		factor.x, 0, 0, 0,
+		0, factor.y, 0, 0,
+		0, 0, factor.z, 0,
+		0, 0, 0, 1
+	};
+	transform( matrix );
+}
+
+void ofMeshd::rotate( double angle, const ofVec3d& axis ) {
+	rotateRad( angle * DEG_TO_RAD, axis );
+}
+
+void ofMeshd::rotateRad( double angle, const ofVec3d& axis ) {
+	// same rotation as ofVec3d::rotateRad(), built once for the whole mesh
+	ofVec3d ax = axis.getNormalized();
+	double sina = sin( angle );
+	double cosa = cos( angle );
+	double cosb = 1.0 - cosa;
+	double matrix[16] = {
+		ax.x*ax.x*cosb + cosa,      ax.y*ax.x*cosb + ax.z*sina, ax.z*ax.x*cosb - ax.y*sina, 0,
+		ax.x*ax.y*cosb - ax.z*sina, ax.y*ax.y*cosb + cosa,      ax.z*ax.y*cosb + ax.x*sina, 0,
+		ax.x*ax.z*cosb + ax.y*sina, ax.y*ax.z*cosb - ax.x*sina, ax.z*ax.z*cosb + cosa,      0,
+		0, 0, 0, 1
+	};
+	transform( matrix );
+}
+
+void ofMeshd::transform( const double* m ) {
+	ofParallelFor( 0, vertices.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d p = vertices[i];
+			vertices[i].set( m[0]*p.x + m[4]*p.y + m[8]*p.z + m[12],
+							m[1]*p.x + m[5]*p.y + m[9]*p.z + m[13],
+							m[2]*p.x + m[6]*p.y + m[10]*p.z + m[14] );
+		}
+	}, MESH_MIN_CHUNK );
+
+	if( !hasNormals() ) {
+		return;
+	}
+	// cofactor matrix = determinant * inverse transpose, the scale goes away when renormalizing
+	double a = m[0], b = m[4], c = m[8];
+	double d = m[1], e = m[5], f = m[9];
+	double g = m[2], h = m[6], k = m[10];
+	double c00 = e*k - f*h, c01 = f*g - d*k, c02 = d*h - e*g;
+	double c10 = c*h - b*k, c11 = a*k - c*g, c12 = b*g - a*h;
+	double c20 = b*f - c*e, c21 = c*d - a*f, c22 = a*e - b*d;
+	double det = a*c00 + b*c01 + c*c02;
+	double sign = det < 0 ? -1.0 : 1.0;
+	ofParallelFor( 0, normals.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d n = normals[i];
+			ofVec3d r( c00*n.x + c01*n.y + c02*n.z,
+					  c10*n.x + c11*n.y + c12*n.z,
+					  c20*n.x + c21*n.y + c22*n.z );
+			normals[i] = r.normalize() * sign;
+		}
+	}, MESH_MIN_CHUNK );
+}
+
+void ofMeshd::computeNormals( ofNormalWeighting weighting ) {
+	if( adjacencyDirty || adjacency.offsets.size() != vertices.size() + 1 ) {
+		adjacency.build( indices.data(), indices.size() / 3, vertices.size() );
+		adjacencyDirty = false;
+	}
+	normals.resize( vertices.size() );
+	ofComputeVertexNormals( vertices.data(), vertices.size(), indices.data(), indices.size() / 3,
+						   adjacency, normals.data(), weighting );
+}
+
+
+// Conversion to float.
+//
+//
+void ofMeshd::getVertexBuffer( float* out, const ofVec3d& origin ) const {
+	ofParallelFor( 0, vertices.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i*3 + 0] = (float)(vertices[i].x - origin.x);
+			out[i*3 + 1] = (float)(vertices[i].y - origin.y);
+			out[i*3 + 2] = (float)(vertices[i].z - origin.z);
+		}
+	}, MESH_MIN_CHUNK );
+}
+
+size_t ofMeshd::getInterleavedStride() const {
+	return 3 + (hasNormals() ? 3 : 0) + (hasTexCoords() ? 2 : 0);
+}
+
+size_t ofMeshd::getInterleavedBuffer( float* out, const ofVec3d& origin ) const {
+	const size_t stride = getInterleavedStride();
+	const bool withNormals = hasNormals();
+	const bool withTexCoords = hasTexCoords();
+	ofParallelFor( 0, vertices.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			float* v = out + i * stride;
+			*v++ = (float)(vertices[i].x - origin.x);
+			*v++ = (float)(vertices[i].y - origin.y);
+			*v++ = (float)(vertices[i].z - origin.z);
+			if( withNormals ) {
+				*v++ = (float)normals[i].x;
+				*v++ = (float)normals[i].y;
+				*v++ = (float)normals[i].z;
+			}
+			if( withTexCoords ) {
+				*v++ = (float)texCoords[i].x;
+				*v++ = (float)texCoords[i].y;
+			}
+		}
+	}, MESH_MIN_CHUNK );
+	return stride;
+}
+
+ofMesh ofMeshd::getMesh( const ofVec3d& origin ) const {
+	ofMesh mesh;
+	mesh.setMode( OF_PRIMITIVE_TRIANGLES );
+
+	if( vertices.empty() ) {
+		return mesh;
+	}
+	std::vector<ofVec3f>& verts = mesh.getVertices();
+	verts.resize( vertices.size() );
+	getVertexBuffer( &verts[0].x, origin );
+
+	if( hasNormals() ) {
+		std::vector<ofVec3f>& n = mesh.getNormals();
+		n.resize( normals.size() );
+		ofParallelFor( 0, normals.size(), [&]( size_t begin, size_t end ) {
+			for( size_t i=begin; i<end; i++ ) {
+				n[i] = normals[i];
+			}
+		}, MESH_MIN_CHUNK );
+	}
+	if( hasTexCoords() ) {
+		std::vector<ofVec2f>& t = mesh.getTexCoords();
+		t.resize( texCoords.size() );
+		for( size_t i=0; i<texCoords.size(); i++ ) {
+			t[i] = texCoords[i];
+		}
+	}
+	mesh.getIndices().assign( indices.begin(), indices.end() );
+	return mesh;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "ofVec2d.h"
+#include "ofVec3d.h"
+#include "ofMeshNormalsd.h"
+#include "ofMesh.h"
+
+#include <vector>
+
+/// \brief ofMeshd is a double precision indexed triangle mesh.
+///
+/// Every attribute lives in its own contiguous array (positions, normals and
+/// texture coordinates), so batch operations only touch the attribute they
+/// change, and indices are 32 bit. Attributes other than positions are
+/// optional: they are used when they hold one element per vertex.
+///
+/// Build large meshes with reserve() or the bulk add functions to avoid
+/// repeated reallocation:
+///
+/// ~~~~{.cpp}
+/// ofMeshd mesh;
+/// mesh.reserve(numVertices, numTriangles * 3);
+/// mesh.addVertices(positions.data(), positions.size());
+/// mesh.addIndices(indices.data(), indices.size());
+/// mesh.computeNormals();
+///
+/// // render relative to the camera to keep float precision
+/// ofMesh renderMesh = mesh.getMesh(camera.getPosition());
+/// ~~~~
+class ofMeshd {
+public:
+	ofMeshd();
+
+	/// \brief Reserves memory for the vertex attributes and indices.
+	///
+	/// \param withNormals Also reserve normals.
+	/// \param withTexCoords Also reserve texture coordinates.
+	void reserve( size_t numVertices, size_t numIndices, bool withNormals = true, bool withTexCoords = false );
+
+	/// \brief Removes all the vertices and indices.
+	void clear();
+
+	//---------------------
+	/// \name Vertices and attributes
+	/// \{
+
+	void addVertex( const ofVec3d& v );
+	void addVertices( const ofVec3d* verts, size_t num );
+	void addNormal( const ofVec3d& n );
+	void addNormals( const ofVec3d* normals, size_t num );
+	void addTexCoord( const ofVec2d& t );
+	void addTexCoords( const ofVec2d* texCoords, size_t num );
+
+	size_t getNumVertices() const;
+	bool hasNormals() const;
+	bool hasTexCoords() const;
+
+	std::vector<ofVec3d>& getVertices();
+	const std::vector<ofVec3d>& getVertices() const;
+	std::vector<ofVec3d>& getNormals();
+	const std::vector<ofVec3d>& getNormals() const;
+	std::vector<ofVec2d>& getTexCoords();
+	const std::vector<ofVec2d>& getTexCoords() const;
+
+	/// \}
+
+	//---------------------
+	/// \name Indices
+	/// \{
+
+	void addIndex( unsigned int i );
+	void addIndices( const unsigned int* indices, size_t num );
+	void addTriangle( unsigned int a, unsigned int b, unsigned int c );
+
+	size_t getNumIndices() const;
+
+	/// \brief Returns the indices, three per triangle.
+	///
+	/// Call indicesChanged() after modifying them through this reference so
+	/// computeNormals() rebuilds its vertex adjacency.
+	std::vector<unsigned int>& getIndices();
+	const std::vector<unsigned int>& getIndices() const;
+	void indicesChanged();
+
+	/// \}
+
+	//---------------------
+	/// \name Batch transforms
+	/// \{
+
+	/// \brief Moves every vertex by 'offset'.
+	void translate( const ofVec3d& offset );
+
+	/// \brief Scales every vertex by 'factor' around the origin, normals are updated.
+	void scale( const ofVec3d& factor );
+
+	/// \brief Rotates vertices and normals by 'angle' degrees around 'axis'.
+	void rotate( double angle, const ofVec3d& axis );
+
+	/// \brief Rotates vertices and normals by 'angle' radians around 'axis'.
+	void rotateRad( double angle, const ofVec3d& axis );
+
+	/// \brief Transforms the vertices by a 4x4 matrix stored like OpenGL and
+	/// ofMatrix4x4::getPtr() (translation in elements 12, 13 and 14).
+	/// Normals are transformed by the inverse transpose and renormalized.
+	void transform( const double* matrix );
+
+	/// \brief Recomputes one normal per vertex from the triangles.
+	void computeNormals( ofNormalWeighting weighting = OF_NORMAL_WEIGHT_AREA );
+
+	/// \}
+
+	//---------------------
+	/// \name Conversion to float
+	/// \{
+
+	/// \brief Writes 3 floats per vertex into 'out', relative to 'origin'.
+	///
+	/// Subtracting the origin in double before converting keeps full float
+	/// precision near the origin, typically the camera position.
+	void getVertexBuffer( float* out, const ofVec3d& origin = ofVec3d() ) const;
+
+	/// \brief Writes the vertex attributes interleaved into 'out': position,
+	/// then normal and texture coordinate when present.
+	///
+	/// \returns The number of floats per vertex, see getInterleavedStride().
+	size_t getInterleavedBuffer( float* out, const ofVec3d& origin = ofVec3d() ) const;
+
+	/// \brief Returns the number of floats per vertex written by getInterleavedBuffer().
+	size_t getInterleavedStride() const;
+
+	/// \brief Returns a float copy of the mesh, relative to 'origin'.
+	ofMesh getMesh( const ofVec3d& origin = ofVec3d() ) const;
+
+	/// \}
+
+private:
+	std::vector<ofVec3d> vertices;
+	std::vector<ofVec3d> normals;
+	std::vector<ofVec2d> texCoords;
+	std::vector<unsigned int> indices;
+
+	ofVertexFaceAdjacency adjacency;
+	bool adjacencyDirty;
+};
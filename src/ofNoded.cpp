@@ -0,0 +1,212 @@
+#include "ofNoded.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// smallest number of nodes worth a thread
+const size_t NODES_MIN_CHUNK = 1024;
+
+}
+
+
+ofNoded::ofNoded()
+:parent(NULL)
+,scale(1, 1, 1)
+,localDirty(true)
+,globalDirty(true)
+,globalVersion(0)
+,parentVersion(0) {}
+
+ofNoded::~ofNoded() {
+	clearParent();
+	for( size_t i=0; i<children.size(); i++ ) {
+		children[i]->parent = NULL;
+		children[i]->markDirty();
+	}
+}
+
+
+// Hierarchy.
+//
+//
+void ofNoded::setParent( ofNoded& newParent ) {
+	for( const ofNoded* ancestor=&newParent; ancestor!=NULL; ancestor=ancestor->parent ) {
+		if( ancestor == this ) {
+			return;
+		}
+	}
+	if( parent == &newParent ) {
+		return;
+	}
+	clearParent();
+	parent = &newParent;
+	parent->children.push_back( this );
+	markDirty();
+}
+
+void ofNoded::clearParent() {
+	if( parent == NULL ) {
+		return;
+	}
+	std::vector<ofNoded*>& siblings = parent->children;
+	siblings.erase( std::find( siblings.begin(), siblings.end(), this ) );
+	parent = NULL;
+	markDirty();
+}
+
+ofNoded* ofNoded::getParent() const {
+	return parent;
+}
+
+const std::vector<ofNoded*>& ofNoded::getChildren() const {
+	return children;
+}
+
+
+// Local transform.
+//
+//
+void ofNoded::setPosition( double x, double y, double z ) {
+	setPosition( ofVec3d( x, y, z ) );
+}
+
+void ofNoded::setPosition( const ofVec3d& _position ) {
+	position = _position;
+	localDirty = true;
+	markDirty();
+}
+
+void ofNoded::setOrientation( const ofQuaterniond& _orientation ) {
+	orientation = _orientation;
+	localDirty = true;
+	markDirty();
+}
+
+void ofNoded::setScale( double s ) {
+	setScale( ofVec3d( s, s, s ) );
+}
+
+void ofNoded::setScale( const ofVec3d& _scale ) {
+	scale = _scale;
+	localDirty = true;
+	markDirty();
+}
+
+void ofNoded::move( const ofVec3d& offset ) {
+	setPosition( position + offset );
+}
+
+void ofNoded::rotate( double angle, const ofVec3d& axis ) {
+	setOrientation( orientation * ofQuaterniond( angle, axis ) );
+}
+
+const ofVec3d& ofNoded::getPosition() const {
+	return position;
+}
+
+const ofQuaterniond& ofNoded::getOrientationQuat() const {
+	return orientation;
+}
+
+const ofVec3d& ofNoded::getScale() const {
+	return scale;
+}
+
+const ofMatrix4x4d& ofNoded::getLocalTransformMatrix() const {
+	if( localDirty ) {
+		localTransform.makeTransformMatrix( position, orientation, scale );
+		localDirty = false;
+	}
+	return localTransform;
+}
+
+
+// Global transform.
+//
+//
+void ofNoded::markDirty() {
+	globalDirty = true;
+}
+
+void ofNoded::updateFromParent() const {
+	if( !globalDirty && (parent == NULL || parentVersion == parent->globalVersion) ) {
+		return;
+	}
+	if( parent != NULL ) {
+		globalTransform = getLocalTransformMatrix() * parent->globalTransform;
+		parentVersion = parent->globalVersion;
+	} else {
+		globalTransform = getLocalTransformMatrix();
+	}
+	globalDirty = false;
+	globalVersion++;
+}
+
+const ofMatrix4x4d& ofNoded::getGlobalTransformMatrix() const {
+	if( parent != NULL ) {
+		parent->getGlobalTransformMatrix();
+	}
+	updateFromParent();
+	return globalTransform;
+}
+
+ofVec3d ofNoded::getGlobalPosition() const {
+	return getGlobalTransformMatrix().getTranslation();
+}
+
+ofQuaterniond ofNoded::getGlobalOrientation() const {
+	if( parent == NULL ) {
+		return orientation;
+	}
+	return orientation * parent->getGlobalOrientation();
+}
+
+
+// Hierarchy updates.
+//
+//
+void ofNodeHierarchyd::setup( ofNoded* const* roots, size_t numRoots ) {
+	nodes.assign( roots, roots + numRoots );
+	levels.clear();
+	size_t begin = 0;
+	while( begin < nodes.size() ) {
+		levels.push_back( begin );
+		const size_t end = nodes.size();
+		for( size_t i=begin; i<end; i++ ) {
+			nodes.insert( nodes.end(), nodes[i]->children.begin(), nodes[i]->children.end() );
+		}
+		begin = end;
+	}
+	levels.push_back( nodes.size() );
+}
+
+void ofNodeHierarchyd::update() {
+	if( nodes.empty() ) {
+		return;
+	}
+	// roots may hang below nodes that are not collected
+	for( size_t i=levels[0]; i<levels[1]; i++ ) {
+		nodes[i]->getGlobalTransformMatrix();
+	}
+	for( size_t level=1; level+1<levels.size(); level++ ) {
+		ofParallelFor( levels[level], levels[level + 1], [&]( size_t begin, size_t end ) {
+			for( size_t i=begin; i<end; i++ ) {
+				nodes[i]->updateFromParent();
+			}
+		}, NODES_MIN_CHUNK );
+	}
+}
+
+size_t ofNodeHierarchyd::getNumNodes() const {
+	return nodes.size();
+}
+
+size_t ofNodeHierarchyd::getNumLevels() const {
+	return levels.empty() ? 0 : levels.size() - 1;
+}
+
+const std::vector<ofNoded*>& ofNodeHierarchyd::getNodes() const {
+	return nodes;
+}
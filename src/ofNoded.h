@@ -0,0 +1,133 @@
+#pragma once
+
+#include "ofVec3d.h"
+#include "ofQuaterniond.h"
+#include "ofMatrix4x4d.h"
+
+#include <vector>
+
+/// \brief ofNoded is a double precision scene graph node: a position, an
+/// orientation and a scale relative to an optional parent, like ofNode.
+///
+/// Transforms are computed on demand and cached. Changing a node only flags
+/// it, and every node remembers which version of its parent's global
+/// transform it was computed from, so getGlobalTransformMatrix() only
+/// recomputes the nodes between the root and the node that changed, and
+/// moving a node never walks its subtree. ofNodeHierarchyd updates whole
+/// hierarchies at once, breadth first and in parallel.
+///
+/// Nodes do not own their children; deleting a node detaches its parent and
+/// children. Nodes cannot be copied.
+///
+/// ~~~~{.cpp}
+/// ofNoded planet, moon;
+/// moon.setParent(planet);
+/// moon.setPosition(384400e3, 0, 0);
+/// planet.rotate(0.01, ofVec3d(0, 1, 0));
+/// ofVec3d moonPosition = moon.getGlobalPosition(); // recomputes planet, then moon
+/// ~~~~
+class ofNoded {
+public:
+	ofNoded();
+	virtual ~ofNoded();
+
+	/// \brief Attaches this node to 'parent', keeping its local transform.
+	/// Does nothing if 'parent' is this node or one of its descendants.
+	void setParent( ofNoded& parent );
+	void clearParent();
+	ofNoded* getParent() const;
+	const std::vector<ofNoded*>& getChildren() const;
+
+	void setPosition( double x, double y, double z );
+	void setPosition( const ofVec3d& position );
+	void setOrientation( const ofQuaterniond& orientation );
+	void setScale( double scale );
+	void setScale( const ofVec3d& scale );
+
+	/// \brief Moves the node by 'offset', in the space of its parent.
+	void move( const ofVec3d& offset );
+
+	/// \brief Rotates the node by 'angle' degrees around 'axis', after its
+	/// current orientation.
+	void rotate( double angle, const ofVec3d& axis );
+
+	const ofVec3d& getPosition() const;
+	const ofQuaterniond& getOrientationQuat() const;
+	const ofVec3d& getScale() const;
+
+	/// \brief Returns the transform from the node to its parent.
+	const ofMatrix4x4d& getLocalTransformMatrix() const;
+
+	/// \brief Returns the transform from the node to the world, recomputing
+	/// it and its ancestors' if they changed.
+	const ofMatrix4x4d& getGlobalTransformMatrix() const;
+
+	ofVec3d getGlobalPosition() const;
+	ofQuaterniond getGlobalOrientation() const;
+
+private:
+	friend class ofNodeHierarchyd;
+
+	ofNoded( const ofNoded& );
+	ofNoded& operator=( const ofNoded& );
+
+	void markDirty();
+
+	// Brings the global transform up to date, assuming the parent's is.
+	void updateFromParent() const;
+
+	ofNoded* parent;
+	std::vector<ofNoded*> children;
+
+	ofVec3d position;
+	ofQuaterniond orientation;
+	ofVec3d scale;
+
+	mutable ofMatrix4x4d localTransform;
+	mutable ofMatrix4x4d globalTransform;
+	mutable bool localDirty;
+	mutable bool globalDirty;
+	// incremented every time the global transform is recomputed
+	mutable unsigned long long globalVersion;
+	// the parent's globalVersion the global transform was computed from
+	mutable unsigned long long parentVersion;
+};
+
+
+/// \brief ofNodeHierarchyd updates the global transforms of whole node
+/// hierarchies in one pass.
+///
+/// setup() flattens the hierarchies into one array, breadth first, so that
+/// every depth is a contiguous range whose nodes only depend on the depth
+/// above. update() then walks the depths in order and updates the nodes of
+/// each depth in parallel, recomputing only the nodes that changed or whose
+/// parent did. Afterwards getGlobalTransformMatrix() returns the cached
+/// transforms without any work, and may be called from several threads.
+///
+/// ~~~~{.cpp}
+/// ofNodeHierarchyd hierarchy;
+/// hierarchy.setup(&root, 1); // again whenever nodes are added or removed
+/// // every frame
+/// animate(nodes);
+/// hierarchy.update();
+/// ~~~~
+class ofNodeHierarchyd {
+public:
+	/// \brief Collects 'roots' and all their descendants. No root may be the
+	/// descendant of another; a root with a parent is updated after its ancestors.
+	void setup( ofNoded* const* roots, size_t numRoots );
+
+	/// \brief Brings the global transforms of all the collected nodes up to date.
+	void update();
+
+	size_t getNumNodes() const;
+	size_t getNumLevels() const;
+
+	/// \brief Returns the nodes in breadth first order.
+	const std::vector<ofNoded*>& getNodes() const;
+
+private:
+	std::vector<ofNoded*> nodes;
+	// start of every depth in 'nodes', then the end
+	std::vector<size_t> levels;
+};
@@ -0,0 +1,302 @@
+#include "ofNoised.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of points worth a thread
+const size_t NOISE_MIN_CHUNK = 4096;
+
+// gradients along the edges of a cube, also used in 2D with their x and y
+const double GRAD3[12][3] = {
+	{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+	{ 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+	{ 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 }
+};
+
+// gradients towards the edges of a tesseract
+const double GRAD4[32][4] = {
+	{ 0, 1, 1, 1 }, { 0, 1, 1, -1 }, { 0, 1, -1, 1 }, { 0, 1, -1, -1 },
+	{ 0, -1, 1, 1 }, { 0, -1, 1, -1 }, { 0, -1, -1, 1 }, { 0, -1, -1, -1 },
+	{ 1, 0, 1, 1 }, { 1, 0, 1, -1 }, { 1, 0, -1, 1 }, { 1, 0, -1, -1 },
+	{ -1, 0, 1, 1 }, { -1, 0, 1, -1 }, { -1, 0, -1, 1 }, { -1, 0, -1, -1 },
+	{ 1, 1, 0, 1 }, { 1, 1, 0, -1 }, { 1, -1, 0, 1 }, { 1, -1, 0, -1 },
+	{ -1, 1, 0, 1 }, { -1, 1, 0, -1 }, { -1, -1, 0, 1 }, { -1, -1, 0, -1 },
+	{ 1, 1, 1, 0 }, { 1, 1, -1, 0 }, { 1, -1, 1, 0 }, { 1, -1, -1, 0 },
+	{ -1, 1, 1, 0 }, { -1, 1, -1, 0 }, { -1, -1, 1, 0 }, { -1, -1, -1, 0 }
+};
+
+// scales bringing the simplex noises to about [-1, 1]
+const double SIMPLEX2_SCALE = 70.0;
+const double SIMPLEX3_SCALE = 76.0;
+const double SIMPLEX4_SCALE = 62.0;
+
+// the 32 gradients of the 4D Perlin noise are longer than the 3D ones, this
+// brings it back to about [-1, 1] like the others
+const double PERLIN4_SCALE = 0.87;
+
+// offsets of the three noises of the curl noise potential
+const ofVec3d CURL_OFFSET_Y( 123.4, -45.6, 789.1 );
+const ofVec3d CURL_OFFSET_Z( -345.6, 912.3, -67.8 );
+
+// Folds the high half of a lattice coordinate into the low one, so the hash
+// sees all 64 bits; coordinates below 2^32 are left as they are.
+inline unsigned int foldCoordinate( long long v ) {
+	const unsigned long long u = (unsigned long long)v;
+	return (unsigned int)u ^ ((unsigned int)(u >> 32) * 0x9e3779b1u);
+}
+
+// Integer hash of a lattice point, no table so no period.
+inline unsigned int hashLattice( long long x, long long y, long long z = 0, long long w = 0 ) {
+	unsigned int h = 0x2545f491u;
+	h = (h ^ foldCoordinate( x )) * 0x9e3779b1u; h ^= h >> 15;
+	h = (h ^ foldCoordinate( y )) * 0x85ebca77u; h ^= h >> 13;
+	h = (h ^ foldCoordinate( z )) * 0xc2b2ae3du; h ^= h >> 16;
+	h = (h ^ foldCoordinate( w )) * 0x27d4eb2fu; h ^= h >> 15;
+	h *= 0x846ca68bu;
+	h ^= h >> 16;
+	return h;
+}
+
+inline long long fastFloor( double v ) {
+	long long i = (long long)v;
+	return v < i ? i - 1 : i;
+}
+
+inline double fade( double t ) {
+	return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+// Perlin noise in D dimensions: the gradients of the 2^D corners of the cell,
+// blended with the fade curve.
+template<int D>
+double perlin( const double* p ) {
+	long long cell[4] = { 0, 0, 0, 0 };
+	double f[D], u[D];
+	for( int k=0; k<D; k++ ) {
+		cell[k] = fastFloor( p[k] );
+		f[k] = p[k] - cell[k];
+		u[k] = fade( f[k] );
+	}
+	double sum = 0;
+	for( int c=0; c<(1 << D); c++ ) {
+		long long q[4] = { cell[0], cell[1], cell[2], cell[3] };
+		double weight = 1;
+		double d[D];
+		for( int k=0; k<D; k++ ) {
+			int bit = (c >> k) & 1;
+			q[k] += bit;
+			d[k] = f[k] - bit;
+			weight *= bit ? u[k] : 1.0 - u[k];
+		}
+		unsigned int h = hashLattice( q[0], q[1], q[2], q[3] );
+		const double* g = D == 4 ? GRAD4[h & 31] : GRAD3[h % 12];
+		double dot = 0;
+		for( int k=0; k<D; k++ ) {
+			dot += g[k] * d[k];
+		}
+		sum += weight * dot;
+	}
+	return D == 4 ? PERLIN4_SCALE * sum : sum;
+}
+
+double simplex2( double x, double y ) {
+	const double F2 = 0.5 * (sqrt( 3.0 ) - 1.0);
+	const double G2 = (3.0 - sqrt( 3.0 )) / 6.0;
+	double s = (x + y) * F2;
+	long long i = fastFloor( x + s );
+	long long j = fastFloor( y + s );
+	double t = (i + j) * G2;
+	double x0 = x - (i - t), y0 = y - (j - t);
+	int i1 = x0 > y0 ? 1 : 0;
+	int j1 = 1 - i1;
+	double xs[3] = { x0, x0 - i1 + G2, x0 - 1.0 + 2.0 * G2 };
+	double ys[3] = { y0, y0 - j1 + G2, y0 - 1.0 + 2.0 * G2 };
+	long long is[3] = { i, i + i1, i + 1 };
+	long long js[3] = { j, j + j1, j + 1 };
+	double n = 0;
+	for( int c=0; c<3; c++ ) {
+		double r = 0.5 - xs[c] * xs[c] - ys[c] * ys[c];
+		if( r > 0 ) {
+			const double* g = GRAD3[hashLattice( is[c], js[c] ) % 12];
+			r *= r;
+			n += r * r * (g[0] * xs[c] + g[1] * ys[c]);
+		}
+	}
+	return SIMPLEX2_SCALE * n;
+}
+
+double simplex3( double x, double y, double z, double* gradient ) {
+	const double F3 = 1.0 / 3.0;
+	const double G3 = 1.0 / 6.0;
+	double s = (x + y + z) * F3;
+	long long i = fastFloor( x + s );
+	long long j = fastFloor( y + s );
+	long long k = fastFloor( z + s );
+	double t = (i + j + k) * G3;
+	double x0 = x - (i - t), y0 = y - (j - t), z0 = z - (k - t);
+	// the simplex the point is in, from the order of the coordinates
+	int i1, j1, k1, i2, j2, k2;
+	if( x0 >= y0 ) {
+		if( y0 >= z0 ) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+		else if( x0 >= z0 ) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+		else { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+	} else {
+		if( y0 < z0 ) { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+		else if( x0 < z0 ) { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+		else { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+	}
+	double xs[4] = { x0, x0 - i1 + G3, x0 - i2 + 2.0 * G3, x0 - 1.0 + 3.0 * G3 };
+	double ys[4] = { y0, y0 - j1 + G3, y0 - j2 + 2.0 * G3, y0 - 1.0 + 3.0 * G3 };
+	double zs[4] = { z0, z0 - k1 + G3, z0 - k2 + 2.0 * G3, z0 - 1.0 + 3.0 * G3 };
+	long long is[4] = { i, i + i1, i + i2, i + 1 };
+	long long js[4] = { j, j + j1, j + j2, j + 1 };
+	long long ks[4] = { k, k + k1, k + k2, k + 1 };
+	double n = 0, gx = 0, gy = 0, gz = 0;
+	for( int c=0; c<4; c++ ) {
+		double r = 0.5 - xs[c] * xs[c] - ys[c] * ys[c] - zs[c] * zs[c];
+		if( r > 0 ) {
+			const double* g = GRAD3[hashLattice( is[c], js[c], ks[c] ) % 12];
+			double dot = g[0] * xs[c] + g[1] * ys[c] + g[2] * zs[c];
+			double r2 = r * r;
+			double r4 = r2 * r2;
+			n += r4 * dot;
+			if( gradient ) {
+				// d(r^4 dot) = -8 r^3 dot d + r^4 g
+				double a = -8.0 * r2 * r * dot;
+				gx += a * xs[c] + r4 * g[0];
+				gy += a * ys[c] + r4 * g[1];
+				gz += a * zs[c] + r4 * g[2];
+			}
+		}
+	}
+	if( gradient ) {
+		gradient[0] = SIMPLEX3_SCALE * gx;
+		gradient[1] = SIMPLEX3_SCALE * gy;
+		gradient[2] = SIMPLEX3_SCALE * gz;
+	}
+	return SIMPLEX3_SCALE * n;
+}
+
+double simplex4( double x, double y, double z, double w ) {
+	const double F4 = (sqrt( 5.0 ) - 1.0) / 4.0;
+	const double G4 = (5.0 - sqrt( 5.0 )) / 20.0;
+	double s = (x + y + z + w) * F4;
+	long long i = fastFloor( x + s );
+	long long j = fastFloor( y + s );
+	long long k = fastFloor( z + s );
+	long long l = fastFloor( w + s );
+	double t = (i + j + k + l) * G4;
+	double d0[4] = { x - (i - t), y - (j - t), z - (k - t), w - (l - t) };
+	// rank of every coordinate gives the simplex the point is in
+	int rank[4] = { 0, 0, 0, 0 };
+	for( int a=0; a<4; a++ ) {
+		for( int b=a+1; b<4; b++ ) {
+			if( d0[a] > d0[b] ) {
+				rank[a]++;
+			} else {
+				rank[b]++;
+			}
+		}
+	}
+	const long long base[4] = { i, j, k, l };
+	double n = 0;
+	for( int c=0; c<5; c++ ) {
+		// corner c is offset by 1 on the axes of rank >= 4 - c
+		long long q[4];
+		double d[4];
+		double r = 0.5;
+		for( int a=0; a<4; a++ ) {
+			int o = rank[a] >= 4 - c ? 1 : 0;
+			q[a] = base[a] + o;
+			d[a] = d0[a] - o + c * G4;
+			r -= d[a] * d[a];
+		}
+		if( r > 0 ) {
+			const double* g = GRAD4[hashLattice( q[0], q[1], q[2], q[3] ) & 31];
+			r *= r;
+			n += r * r * (g[0] * d[0] + g[1] * d[1] + g[2] * d[2] + g[3] * d[3]);
+		}
+	}
+	return SIMPLEX4_SCALE * n;
+}
+
+ofVec3d curl( const ofVec3d& p ) {
+	double a[3], b[3], c[3];
+	simplex3( p.x, p.y, p.z, a );
+	simplex3( p.x + CURL_OFFSET_Y.x, p.y + CURL_OFFSET_Y.y, p.z + CURL_OFFSET_Y.z, b );
+	simplex3( p.x + CURL_OFFSET_Z.x, p.y + CURL_OFFSET_Z.y, p.z + CURL_OFFSET_Z.z, c );
+	// potential (a, b, c), curl = (dc/dy - db/dz, da/dz - dc/dx, db/dx - da/dy)
+	return ofVec3d( c[1] - b[2], a[2] - c[0], b[0] - a[1] );
+}
+
+template<class In, class Out, class Function>
+void evaluate( const In* points, size_t num, Out* out, Function fn ) {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = fn( points[i] );
+		}
+	}, NOISE_MIN_CHUNK );
+}
+
+}
+
+
+double ofPerlinNoise( const ofVec2d& p ) {
+	return perlin<2>( p.getPtr() );
+}
+
+double ofPerlinNoise( const ofVec3d& p ) {
+	return perlin<3>( p.getPtr() );
+}
+
+double ofPerlinNoise( const ofVec4d& p ) {
+	return perlin<4>( p.getPtr() );
+}
+
+double ofSimplexNoise( const ofVec2d& p ) {
+	return simplex2( p.x, p.y );
+}
+
+double ofSimplexNoise( const ofVec3d& p ) {
+	return simplex3( p.x, p.y, p.z, NULL );
+}
+
+double ofSimplexNoise( const ofVec4d& p ) {
+	return simplex4( p.x, p.y, p.z, p.w );
+}
+
+double ofSimplexNoise( const ofVec3d& p, ofVec3d& gradient ) {
+	return simplex3( p.x, p.y, p.z, gradient.getPtr() );
+}
+
+ofVec3d ofCurlNoise( const ofVec3d& p ) {
+	return curl( p );
+}
+
+void ofPerlinNoise( const ofVec2d* points, size_t num, double* out ) {
+	evaluate( points, num, out, []( const ofVec2d& p ) { return perlin<2>( p.getPtr() ); } );
+}
+
+void ofPerlinNoise( const ofVec3d* points, size_t num, double* out ) {
+	evaluate( points, num, out, []( const ofVec3d& p ) { return perlin<3>( p.getPtr() ); } );
+}
+
+void ofPerlinNoise( const ofVec4d* points, size_t num, double* out ) {
+	evaluate( points, num, out, []( const ofVec4d& p ) { return perlin<4>( p.getPtr() ); } );
+}
+
+void ofSimplexNoise( const ofVec2d* points, size_t num, double* out ) {
+	evaluate( points, num, out, []( const ofVec2d& p ) { return simplex2( p.x, p.y ); } );
+}
+
+void ofSimplexNoise( const ofVec3d* points, size_t num, double* out ) {
+	evaluate( points, num, out, []( const ofVec3d& p ) { return simplex3( p.x, p.y, p.z, NULL ); } );
+}
+
+void ofSimplexNoise( const ofVec4d* points, size_t num, double* out ) {
+	evaluate( points, num, out, []( const ofVec4d& p ) { return simplex4( p.x, p.y, p.z, p.w ); } );
+}
+
+void ofCurlNoise( const ofVec3d* points, size_t num, ofVec3d* out ) {
+	evaluate( points, num, out, []( const ofVec3d& p ) { return curl( p ); } );
+}
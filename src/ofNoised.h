@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ofVec2d.h"
+#include "ofVec3d.h"
+#include "ofVec4d.h"
+
+/// \brief Gradient noise in double precision.
+///
+/// The lattice points are integers on 64 bits and their gradients are picked
+/// by an integer hash instead of a permutation table, so the noise keeps its
+/// detail far from the origin where the float ofNoise() breaks down, and has
+/// no period of 256. All the functions return values in about [-1, 1] and
+/// are safe to call from many threads. The array versions split large
+/// batches across threads.
+///
+/// ~~~~{.cpp}
+/// double height = ofSimplexNoise(ofVec2d(x, y) * 0.01);
+///
+/// // move particles along a divergence free flow
+/// ofCurlNoise(positions.data(), positions.size(), velocities.data());
+/// ~~~~
+
+/// \brief Classic (improved) Perlin noise.
+double ofPerlinNoise( const ofVec2d& p );
+double ofPerlinNoise( const ofVec3d& p );
+double ofPerlinNoise( const ofVec4d& p );
+
+/// \brief Simplex noise, cheaper than Perlin noise in 3 and 4 dimensions and
+/// without its axis aligned artifacts.
+double ofSimplexNoise( const ofVec2d& p );
+double ofSimplexNoise( const ofVec3d& p );
+double ofSimplexNoise( const ofVec4d& p );
+
+/// \brief 3D simplex noise and its analytic gradient.
+double ofSimplexNoise( const ofVec3d& p, ofVec3d& gradient );
+
+/// \brief Curl of a vector potential made of three simplex noises: a
+/// divergence free field, like the velocity of an incompressible fluid.
+ofVec3d ofCurlNoise( const ofVec3d& p );
+
+void ofPerlinNoise( const ofVec2d* points, size_t num, double* out );
+void ofPerlinNoise( const ofVec3d* points, size_t num, double* out );
+void ofPerlinNoise( const ofVec4d* points, size_t num, double* out );
+void ofSimplexNoise( const ofVec2d* points, size_t num, double* out );
+void ofSimplexNoise( const ofVec3d* points, size_t num, double* out );
+void ofSimplexNoise( const ofVec4d* points, size_t num, double* out );
+void ofCurlNoise( const ofVec3d* points, size_t num, ofVec3d* out );
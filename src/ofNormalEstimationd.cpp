@@ -0,0 +1,66 @@
+#include "ofNormalEstimationd.h"
+#include "ofKdTree3d.h"
+#include "ofEigen3d.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of points worth a thread
+const size_t NORMALS_MIN_CHUNK = 1024;
+
+}
+
+
+void ofEstimateNormals( const ofVec3d* points, size_t num, ofVec3d* normals,
+					   const ofNormalEstimationSettings& settings ) {
+	if( points == NULL || normals == NULL || num == 0 ) {
+		return;
+	}
+	ofKdTree3d tree;
+	tree.build( points, num );
+	ofEstimateNormals( tree, normals, settings );
+}
+
+void ofEstimateNormals( const ofKdTree3d& tree, ofVec3d* normals,
+					   const ofNormalEstimationSettings& settings ) {
+	size_t num = tree.size();
+	if( normals == NULL || num == 0 ) {
+		return;
+	}
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		std::vector<size_t> neighbors;
+		std::vector<ofVec3d> local;
+		if( settings.radius <= 0 ) {
+			neighbors.resize( settings.numNeighbors );
+		}
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d& p = tree.getPoint( i );
+			size_t found;
+			if( settings.radius > 0 ) {
+				found = tree.findWithinRadius( p, settings.radius, neighbors );
+			} else {
+				found = tree.findNearest( p, settings.numNeighbors, neighbors.empty() ? NULL : &neighbors[0] );
+			}
+			if( found < 3 ) {
+				normals[i].set( 0, 0, 0 );
+				continue;
+			}
+			// centre the neighbourhood on the query point for precision far from the origin
+			local.resize( found );
+			for( size_t n=0; n<found; n++ ) {
+				local[n] = tree.getPoint( neighbors[n] ) - p;
+			}
+			ofVec3d centroid;
+			double covariance[3][3];
+			double eigenvalues[3];
+			ofVec3d eigenvectors[3];
+			ofComputeCovariance3d( &local[0], NULL, found, centroid, covariance );
+			ofEigenSymmetric3d( covariance, eigenvalues, eigenvectors );
+			ofVec3d normal = eigenvectors[0];
+			if( settings.orientTowardsViewpoint && normal.dot( settings.viewpoint - p ) < 0 ) {
+				normal = -normal;
+			}
+			normals[i] = normal;
+		}
+	}, NORMALS_MIN_CHUNK );
+}
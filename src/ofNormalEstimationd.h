@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+class ofKdTree3d;
+
+/// \brief Settings for ofEstimateNormals().
+struct ofNormalEstimationSettings {
+	ofNormalEstimationSettings();
+
+	/// \brief Number of nearest neighbours used for each point, the point included.
+	/// Ignored when 'radius' is positive.
+	size_t numNeighbors;
+
+	/// \brief When positive, neighbourhoods are all the points within this
+	/// distance instead of the 'numNeighbors' nearest.
+	double radius;
+
+	/// \brief Normals are flipped to face this point when 'orientTowardsViewpoint' is true,
+	/// typically the position of the scanner.
+	ofVec3d viewpoint;
+	bool orientTowardsViewpoint;
+};
+
+/// \brief Estimates a unit normal for every point of a cloud.
+///
+/// Each normal is the eigenvector of the smallest eigenvalue of the covariance
+/// of the point's neighbourhood (local PCA). Neighbourhoods come from a k-d
+/// tree built once, and points are processed in parallel, each thread writing
+/// its own range of 'normals'. Points with fewer than 3 neighbours get a zero
+/// normal.
+///
+/// ~~~~{.cpp}
+/// vector<ofVec3d> normals(cloud.size());
+/// ofNormalEstimationSettings settings;
+/// settings.numNeighbors = 12;
+/// settings.viewpoint = scannerPosition;
+/// ofEstimateNormals(cloud.data(), cloud.size(), normals.data(), settings);
+/// ~~~~
+///
+/// \param points The array of points.
+/// \param num The number of points.
+/// \param normals Preallocated array receiving 'num' normals.
+void ofEstimateNormals( const ofVec3d* points, size_t num, ofVec3d* normals,
+					   const ofNormalEstimationSettings& settings = ofNormalEstimationSettings() );
+
+/// \brief Estimates a unit normal for every point of an already built k-d tree.
+///
+/// 'normals' receives 'tree.size()' normals, in the order the points were
+/// given to ofKdTree3d::build().
+void ofEstimateNormals( const ofKdTree3d& tree, ofVec3d* normals,
+					   const ofNormalEstimationSettings& settings = ofNormalEstimationSettings() );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofNormalEstimationSettings::ofNormalEstimationSettings()
+:numNeighbors(16)
+,radius(0)
+,viewpoint(0, 0, 0)
+,orientTowardsViewpoint(true) {}
@@ -0,0 +1,231 @@
+#include "ofParticleSystemd.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// smallest number of particles worth a thread
+const size_t PARTICLES_MIN_CHUNK = 16384;
+
+}
+
+
+void ofParticleStated::resize( size_t num ) {
+	px.resize( num, 0.0 ); py.resize( num, 0.0 ); pz.resize( num, 0.0 );
+	vx.resize( num, 0.0 ); vy.resize( num, 0.0 ); vz.resize( num, 0.0 );
+	ax.resize( num, 0.0 ); ay.resize( num, 0.0 ); az.resize( num, 0.0 );
+	resetVerlet();
+}
+
+void ofParticleStated::reserve( size_t num ) {
+	px.reserve( num ); py.reserve( num ); pz.reserve( num );
+	vx.reserve( num ); vy.reserve( num ); vz.reserve( num );
+	ax.reserve( num ); ay.reserve( num ); az.reserve( num );
+}
+
+void ofParticleStated::clear() {
+	resize( 0 );
+}
+
+size_t ofParticleStated::size() const {
+	return px.size();
+}
+
+size_t ofParticleStated::addParticle( const ofVec3d& position, const ofVec3d& velocity ) {
+	px.push_back( position.x ); py.push_back( position.y ); pz.push_back( position.z );
+	vx.push_back( velocity.x ); vy.push_back( velocity.y ); vz.push_back( velocity.z );
+	ax.push_back( 0.0 ); ay.push_back( 0.0 ); az.push_back( 0.0 );
+	resetVerlet();
+	return px.size() - 1;
+}
+
+ofVec3d ofParticleStated::getPosition( size_t i ) const {
+	return ofVec3d( px[i], py[i], pz[i] );
+}
+
+ofVec3d ofParticleStated::getVelocity( size_t i ) const {
+	return ofVec3d( vx[i], vy[i], vz[i] );
+}
+
+ofVec3d ofParticleStated::getAcceleration( size_t i ) const {
+	return ofVec3d( ax[i], ay[i], az[i] );
+}
+
+void ofParticleStated::setPosition( size_t i, const ofVec3d& p ) {
+	px[i] = p.x; py[i] = p.y; pz[i] = p.z;
+}
+
+void ofParticleStated::setVelocity( size_t i, const ofVec3d& v ) {
+	vx[i] = v.x; vy[i] = v.y; vz[i] = v.z;
+}
+
+void ofParticleStated::setAcceleration( size_t i, const ofVec3d& a ) {
+	ax[i] = a.x; ay[i] = a.y; az[i] = a.z;
+}
+
+void ofParticleStated::getPositions( ofVec3d* out ) const {
+	ofParallelFor( 0, size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i].set( px[i], py[i], pz[i] );
+		}
+	}, PARTICLES_MIN_CHUNK );
+}
+
+void ofParticleStated::setAccelerations( const ofVec3d& a ) {
+	std::fill( ax.begin(), ax.end(), a.x );
+	std::fill( ay.begin(), ay.end(), a.y );
+	std::fill( az.begin(), az.end(), a.z );
+}
+
+void ofParticleStated::resetVerlet() {
+	prevX.clear();
+	prevY.clear();
+	prevZ.clear();
+}
+
+
+// Integrators.
+//
+//
+void ofIntegrateEuler( ofParticleStated& s, double dt ) {
+	ofParallelFor( 0, s.size(), [&]( size_t begin, size_t end ) {
+		double* px = &s.px[0]; double* py = &s.py[0]; double* pz = &s.pz[0];
+		double* vx = &s.vx[0]; double* vy = &s.vy[0]; double* vz = &s.vz[0];
+		const double* ax = &s.ax[0]; const double* ay = &s.ay[0]; const double* az = &s.az[0];
+		for( size_t i=begin; i<end; i++ ) {
+			px[i] += vx[i] * dt;
+			py[i] += vy[i] * dt;
+			pz[i] += vz[i] * dt;
+			vx[i] += ax[i] * dt;
+			vy[i] += ay[i] * dt;
+			vz[i] += az[i] * dt;
+		}
+	}, PARTICLES_MIN_CHUNK );
+	s.resetVerlet();
+}
+
+void ofIntegrateSemiImplicitEuler( ofParticleStated& s, double dt ) {
+	ofParallelFor( 0, s.size(), [&]( size_t begin, size_t end ) {
+		double* px = &s.px[0]; double* py = &s.py[0]; double* pz = &s.pz[0];
+		double* vx = &s.vx[0]; double* vy = &s.vy[0]; double* vz = &s.vz[0];
+		const double* ax = &s.ax[0]; const double* ay = &s.ay[0]; const double* az = &s.az[0];
+		for( size_t i=begin; i<end; i++ ) {
+			vx[i] += ax[i] * dt;
+			vy[i] += ay[i] * dt;
+			vz[i] += az[i] * dt;
+			px[i] += vx[i] * dt;
+			py[i] += vy[i] * dt;
+			pz[i] += vz[i] * dt;
+		}
+	}, PARTICLES_MIN_CHUNK );
+	s.resetVerlet();
+}
+
+void ofIntegrateVerlet( ofParticleStated& s, double dt ) {
+	const size_t num = s.size();
+	if( num == 0 || dt == 0 ) {
+		return;
+	}
+	if( s.prevX.size() != num ) {
+		// start from the current velocities
+		s.prevX.resize( num );
+		s.prevY.resize( num );
+		s.prevZ.resize( num );
+		for( size_t i=0; i<num; i++ ) {
+			s.prevX[i] = s.px[i] - s.vx[i] * dt;
+			s.prevY[i] = s.py[i] - s.vy[i] * dt;
+			s.prevZ[i] = s.pz[i] - s.vz[i] * dt;
+		}
+	}
+	const double dt2 = dt * dt;
+	const double invDt = 1.0 / dt;
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		double* px = &s.px[0]; double* py = &s.py[0]; double* pz = &s.pz[0];
+		double* qx = &s.prevX[0]; double* qy = &s.prevY[0]; double* qz = &s.prevZ[0];
+		double* vx = &s.vx[0]; double* vy = &s.vy[0]; double* vz = &s.vz[0];
+		const double* ax = &s.ax[0]; const double* ay = &s.ay[0]; const double* az = &s.az[0];
+		for( size_t i=begin; i<end; i++ ) {
+			double x = px[i], y = py[i], z = pz[i];
+			double nx = 2.0*x - qx[i] + ax[i]*dt2;
+			double ny = 2.0*y - qy[i] + ay[i]*dt2;
+			double nz = 2.0*z - qz[i] + az[i]*dt2;
+			vx[i] = (nx - x) * invDt;
+			vy[i] = (ny - y) * invDt;
+			vz[i] = (nz - z) * invDt;
+			qx[i] = x; qy[i] = y; qz[i] = z;
+			px[i] = nx; py[i] = ny; pz[i] = nz;
+		}
+	}, PARTICLES_MIN_CHUNK );
+}
+
+void ofIntegrateRK4( ofParticleStated& s, double dt, const ofParticleAccelerationFunction& accelerations ) {
+	const size_t num = s.size();
+	if( num == 0 ) {
+		return;
+	}
+	// 'stage' holds the intermediate states, 'dx' and 'dv' the weighted sums of the slopes
+	ofParticleStated stage;
+	stage.resize( num );
+	std::vector<double> dx( num * 3 ), dv( num * 3 );
+
+	stage.px = s.px; stage.py = s.py; stage.pz = s.pz;
+	stage.vx = s.vx; stage.vy = s.vy; stage.vz = s.vz;
+	accelerations( stage );
+
+	const double stepScale[4] = { 0.5, 0.5, 1.0, 0.0 };
+	const double weight[4] = { 1.0, 2.0, 2.0, 1.0 };
+	for( int k=0; k<4; k++ ) {
+		const double h = stepScale[k] * dt;
+		const double w = weight[k];
+		const bool first = k == 0;
+		const bool last = k == 3;
+		ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+			for( size_t i=begin; i<end; i++ ) {
+				// slopes of this stage
+				double kvx = stage.vx[i], kvy = stage.vy[i], kvz = stage.vz[i];
+				double kax = stage.ax[i], kay = stage.ay[i], kaz = stage.az[i];
+				double* sx = &dx[i*3];
+				double* sv = &dv[i*3];
+				if( first ) {
+					sx[0] = w*kvx; sx[1] = w*kvy; sx[2] = w*kvz;
+					sv[0] = w*kax; sv[1] = w*kay; sv[2] = w*kaz;
+				} else {
+					sx[0] += w*kvx; sx[1] += w*kvy; sx[2] += w*kvz;
+					sv[0] += w*kax; sv[1] += w*kay; sv[2] += w*kaz;
+				}
+				if( last ) {
+					const double d6 = dt / 6.0;
+					s.px[i] += sx[0] * d6; s.py[i] += sx[1] * d6; s.pz[i] += sx[2] * d6;
+					s.vx[i] += sv[0] * d6; s.vy[i] += sv[1] * d6; s.vz[i] += sv[2] * d6;
+				} else {
+					// next stage starts from the original state moved along these slopes
+					stage.px[i] = s.px[i] + kvx * h;
+					stage.py[i] = s.py[i] + kvy * h;
+					stage.pz[i] = s.pz[i] + kvz * h;
+					stage.vx[i] = s.vx[i] + kax * h;
+					stage.vy[i] = s.vy[i] + kay * h;
+					stage.vz[i] = s.vz[i] + kaz * h;
+				}
+			}
+		}, PARTICLES_MIN_CHUNK );
+		if( !last ) {
+			accelerations( stage );
+		}
+	}
+	s.resetVerlet();
+}
+
+void ofLimitSpeeds( ofParticleStated& s, double maxSpeed ) {
+	const double max2 = maxSpeed * maxSpeed;
+	ofParallelFor( 0, s.size(), [&]( size_t begin, size_t end ) {
+		double* vx = &s.vx[0]; double* vy = &s.vy[0]; double* vz = &s.vz[0];
+		for( size_t i=begin; i<end; i++ ) {
+			double len2 = vx[i]*vx[i] + vy[i]*vy[i] + vz[i]*vz[i];
+			double ratio = len2 > max2 ? maxSpeed / sqrt( len2 ) : 1.0;
+			vx[i] *= ratio;
+			vy[i] *= ratio;
+			vz[i] *= ratio;
+		}
+	}, PARTICLES_MIN_CHUNK );
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <functional>
+#include <vector>
+
+/// \brief ofParticleStated stores the positions, velocities and accelerations
+/// of a particle system as structure of arrays.
+///
+/// Every component has its own contiguous array ('px', 'py', 'pz', 'vx'...),
+/// so the integrators below run as fused loops over plain doubles that the
+/// compiler can vectorize, split across threads. ofVec3d accessors are
+/// provided for convenience.
+///
+/// ~~~~{.cpp}
+/// ofParticleStated particles;
+/// particles.resize(100000);
+/// // every frame
+/// particles.setAccelerations(ofVec3d(0, -9.81, 0));
+/// ofIntegrateSemiImplicitEuler(particles, dt);
+/// ofLimitSpeeds(particles, 50);
+/// ~~~~
+class ofParticleStated {
+public:
+	/// \brief Resizes every array, new particles are at rest at the origin.
+	void resize( size_t num );
+	void reserve( size_t num );
+	void clear();
+	size_t size() const;
+
+	/// \brief Appends a particle and returns its index.
+	size_t addParticle( const ofVec3d& position, const ofVec3d& velocity = ofVec3d() );
+
+	ofVec3d getPosition( size_t i ) const;
+	ofVec3d getVelocity( size_t i ) const;
+	ofVec3d getAcceleration( size_t i ) const;
+	void setPosition( size_t i, const ofVec3d& p );
+	void setVelocity( size_t i, const ofVec3d& v );
+	void setAcceleration( size_t i, const ofVec3d& a );
+
+	/// \brief Copies the positions into 'out', an array of size() elements.
+	void getPositions( ofVec3d* out ) const;
+
+	/// \brief Sets the acceleration of every particle to 'a'.
+	void setAccelerations( const ofVec3d& a );
+
+	/// \brief Forgets the previous positions used by ofIntegrateVerlet(), call it
+	/// after moving particles by hand.
+	void resetVerlet();
+
+	std::vector<double> px, py, pz;
+	std::vector<double> vx, vy, vz;
+	std::vector<double> ax, ay, az;
+
+	/// \cond INTERNAL
+	// positions at the previous step, only used by ofIntegrateVerlet()
+	std::vector<double> prevX, prevY, prevZ;
+	/// \endcond
+};
+
+/// \brief Computes the accelerations ('ax', 'ay', 'az') of a state from its
+/// positions and velocities, used by ofIntegrateRK4().
+typedef std::function<void( ofParticleStated& state )> ofParticleAccelerationFunction;
+
+/// \brief Explicit Euler: position then velocity, both from the old values.
+void ofIntegrateEuler( ofParticleStated& state, double dt );
+
+/// \brief Semi-implicit (symplectic) Euler: the velocity is updated first and
+/// moves the particle. Stable for most particle systems.
+void ofIntegrateSemiImplicitEuler( ofParticleStated& state, double dt );
+
+/// \brief Position Verlet with a constant time step. Velocities are derived
+/// from the positions. The first step starts from the current velocities.
+void ofIntegrateVerlet( ofParticleStated& state, double dt );
+
+/// \brief Classic fourth order Runge–Kutta.
+///
+/// 'accelerations' is called four times per step, on temporary states holding
+/// the intermediate positions and velocities.
+void ofIntegrateRK4( ofParticleStated& state, double dt, const ofParticleAccelerationFunction& accelerations );
+
+/// \brief Scales down every velocity longer than 'maxSpeed', like ofVec3d::limit().
+void ofLimitSpeeds( ofParticleStated& state, double maxSpeed );
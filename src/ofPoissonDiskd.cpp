@@ -0,0 +1,258 @@
+#include "ofPoissonDiskd.h"
+#include "ofRandomd.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// edge of the tiles of the parallel sampling, in cells; at least 4 so tiles
+// of the same colour never read each other's cells
+const long long POISSON_TILE_CELLS_2D = 32;
+const long long POISSON_TILE_CELLS_3D = 12;
+
+// Four uniforms in (0, 1) from one block of random bits: 32 bits each are
+// plenty for positions in a tile, at half the cost of getUniform().
+inline void getUniforms( ofRandomGeneratord& rng, double u[4] ) {
+	unsigned int bits[4];
+	rng.getBlock( rng.getCounter(), bits );
+	rng.skip( 1 );
+	for( int k=0; k<4; k++ ) {
+		u[k] = (bits[k] + 0.5) * (1.0 / 4294967296.0);
+	}
+}
+
+// Background grid of a D dimensional Poisson-disk sampling. Cells are small
+// enough to hold one point, the 5^D cells around a cell hold every point that
+// can be closer than the radius.
+template<int D>
+class PoissonGrid {
+public:
+	PoissonGrid( const double* _min, const double* _max, double _radius ) {
+		radius = _radius;
+		radius2 = radius * radius;
+		cellSize = radius / sqrt( (double)D );
+		invCellSize = 1.0 / cellSize;
+		size_t numCells = 1;
+		for( int k=0; k<D; k++ ) {
+			min[k] = _min[k];
+			max[k] = _max[k];
+			dims[k] = MAX( (long long)ceil( (max[k] - min[k]) * invCellSize ), 1LL );
+			numCells *= (size_t)dims[k];
+		}
+		points.resize( numCells * D );
+		used.assign( numCells, 0 );
+	}
+
+	// Samples the cells in [cellBegin, cellEnd) on every axis.
+	void sampleRegion( const long long* cellBegin, const long long* cellEnd, ofRandomGeneratord& rng, int numCandidates ) {
+		double regionMin[D], regionMax[D];
+		for( int k=0; k<D; k++ ) {
+			regionMin[k] = min[k] + cellBegin[k] * cellSize;
+			regionMax[k] = MIN( min[k] + cellEnd[k] * cellSize, max[k] );
+			if( regionMax[k] <= regionMin[k] ) {
+				return;
+			}
+		}
+		std::vector<size_t> active;
+		double p[D], u[4];
+		// random darts start the growth, and restart it in areas it could not reach
+		int failures = 0;
+		while( failures < numCandidates ) {
+			getUniforms( rng, u );
+			for( int k=0; k<D; k++ ) {
+				p[k] = regionMin[k] + (regionMax[k] - regionMin[k]) * u[k];
+			}
+			if( !insert( p, active ) ) {
+				failures++;
+				continue;
+			}
+			failures = 0;
+			while( !active.empty() ) {
+				getUniforms( rng, u );
+				size_t a = MIN( (size_t)(u[0] * active.size()), active.size() - 1 );
+				const double* center = &points[active[a] * D];
+				bool found = false;
+				for( int c=0; c<numCandidates && !found; c++ ) {
+					getCandidate( center, rng, p );
+					bool inside = true;
+					for( int k=0; k<D; k++ ) {
+						inside = inside && p[k] >= regionMin[k] && p[k] < regionMax[k];
+					}
+					found = inside && insert( p, active );
+				}
+				if( !found ) {
+					active[a] = active.back();
+					active.pop_back();
+				}
+			}
+		}
+	}
+
+	template<class Vec>
+	void getPoints( std::vector<Vec>& out ) const {
+		out.clear();
+		for( size_t i=0; i<used.size(); i++ ) {
+			if( used[i] ) {
+				Vec v;
+				for( int k=0; k<D; k++ ) {
+					v[k] = points[i * D + k];
+				}
+				out.push_back( v );
+			}
+		}
+	}
+
+	long long dims[D];
+
+private:
+	// Random point at a distance between 'radius' and 2 * 'radius' of 'center',
+	// uniform over the area or volume of the shell.
+	void getCandidate( const double* center, ofRandomGeneratord& rng, double* p ) const {
+		double u[4];
+		getUniforms( rng, u );
+		if( D == 2 ) {
+			double r = radius * sqrt( 1.0 + 3.0 * u[0] );
+			double a = TWO_PI * u[1];
+			p[0] = center[0] + r * cos( a );
+			p[1] = center[1] + r * sin( a );
+		} else {
+			double r = radius * cbrt( 1.0 + 7.0 * u[0] );
+			double z = 2.0 * u[1] - 1.0;
+			double rxy = r * sqrt( MAX( 1.0 - z * z, 0.0 ) );
+			double a = TWO_PI * u[2];
+			p[0] = center[0] + rxy * cos( a );
+			p[1] = center[1] + rxy * sin( a );
+			p[D - 1] = center[D - 1] + r * z;
+		}
+	}
+
+	// Adds 'p' to the grid and the active list if it is far enough from every point.
+	bool insert( const double* p, std::vector<size_t>& active ) {
+		long long cell[D];
+		for( int k=0; k<D; k++ ) {
+			cell[k] = MIN( (long long)((p[k] - min[k]) * invCellSize ), dims[k] - 1 );
+		}
+		long long lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+		for( int k=0; k<D; k++ ) {
+			lo[k] = MAX( cell[k] - 2, 0LL );
+			hi[k] = MIN( cell[k] + 2, dims[k] - 1 );
+		}
+		for( long long z=lo[2]; z<=hi[2]; z++ ) {
+			for( long long y=lo[1]; y<=hi[1]; y++ ) {
+				for( long long x=lo[0]; x<=hi[0]; x++ ) {
+					const size_t index = getCellIndex( x, y, z );
+					if( !used[index] ) {
+						continue;
+					}
+					const double* q = &points[index * D];
+					double d2 = 0;
+					for( int k=0; k<D; k++ ) {
+						d2 += (p[k] - q[k]) * (p[k] - q[k]);
+					}
+					if( d2 < radius2 ) {
+						return false;
+					}
+				}
+			}
+		}
+		const size_t index = getCellIndex( cell[0], cell[1], D > 2 ? cell[D - 1] : 0 );
+		used[index] = 1;
+		for( int k=0; k<D; k++ ) {
+			points[index * D + k] = p[k];
+		}
+		active.push_back( index );
+		return true;
+	}
+
+	size_t getCellIndex( long long x, long long y, long long z ) const {
+		return ((size_t)z * dims[1] + (size_t)y) * dims[0] + (size_t)x;
+	}
+
+	double min[D], max[D];
+	double radius, radius2, cellSize, invCellSize;
+	// one point per cell, valid where 'used' is set
+	std::vector<double> points;
+	std::vector<char> used;
+};
+
+template<int D, class Vec>
+void sample( const Vec& min, const Vec& max, double radius, std::vector<Vec>& out, unsigned long long seed, int numCandidates ) {
+	out.clear();
+	if( radius <= 0 ) {
+		return;
+	}
+	PoissonGrid<D> grid( min.getPtr(), max.getPtr(), radius );
+	long long begin[D], end[D];
+	for( int k=0; k<D; k++ ) {
+		begin[k] = 0;
+		end[k] = grid.dims[k];
+	}
+	ofRandomGeneratord rng( seed );
+	grid.sampleRegion( begin, end, rng, numCandidates );
+	grid.template getPoints<Vec>( out );
+}
+
+template<int D, class Vec>
+void sampleParallel( const Vec& min, const Vec& max, double radius, std::vector<Vec>& out, unsigned long long seed, int numCandidates ) {
+	out.clear();
+	if( radius <= 0 ) {
+		return;
+	}
+	PoissonGrid<D> grid( min.getPtr(), max.getPtr(), radius );
+	const long long tileCells = D == 2 ? POISSON_TILE_CELLS_2D : POISSON_TILE_CELLS_3D;
+	long long numTiles[3] = { 1, 1, 1 };
+	for( int k=0; k<D; k++ ) {
+		numTiles[k] = (grid.dims[k] + tileCells - 1) / tileCells;
+	}
+	// colour c holds the tiles whose coordinate parities match the bits of c
+	for( int color=0; color<(1 << D); color++ ) {
+		std::vector<long long> tiles;
+		for( long long z=0; z<numTiles[2]; z++ ) {
+			for( long long y=0; y<numTiles[1]; y++ ) {
+				for( long long x=0; x<numTiles[0]; x++ ) {
+					int parity = (int)(x & 1) | (int)(y & 1) << 1 | (int)(z & 1) << 2;
+					if( parity == color ) {
+						tiles.push_back( (z * numTiles[1] + y) * numTiles[0] + x );
+					}
+				}
+			}
+		}
+		ofParallelForChunks( tiles.size(), 1, [&]( size_t, size_t first, size_t last ) {
+			for( size_t t=first; t<last; t++ ) {
+				long long tile = tiles[t];
+				long long coords[3] = { tile % numTiles[0], (tile / numTiles[0]) % numTiles[1], tile / (numTiles[0] * numTiles[1]) };
+				long long begin[D], end[D];
+				for( int k=0; k<D; k++ ) {
+					begin[k] = coords[k] * tileCells;
+					end[k] = MIN( begin[k] + tileCells, grid.dims[k] );
+				}
+				// every tile has its own stream, the result does not depend on the threads
+				ofRandomGeneratord rng( seed, (unsigned long long)tile );
+				grid.sampleRegion( begin, end, rng, numCandidates );
+			}
+		});
+	}
+	grid.template getPoints<Vec>( out );
+}
+
+}
+
+
+void ofPoissonDiskSample( const ofVec2d& min, const ofVec2d& max, double radius, std::vector<ofVec2d>& points,
+						 unsigned long long seed, int numCandidates ) {
+	sample<2>( min, max, radius, points, seed, numCandidates );
+}
+
+void ofPoissonDiskSample( const ofVec3d& min, const ofVec3d& max, double radius, std::vector<ofVec3d>& points,
+						 unsigned long long seed, int numCandidates ) {
+	sample<3>( min, max, radius, points, seed, numCandidates );
+}
+
+void ofPoissonDiskSampleParallel( const ofVec2d& min, const ofVec2d& max, double radius, std::vector<ofVec2d>& points,
+								 unsigned long long seed, int numCandidates ) {
+	sampleParallel<2>( min, max, radius, points, seed, numCandidates );
+}
+
+void ofPoissonDiskSampleParallel( const ofVec3d& min, const ofVec3d& max, double radius, std::vector<ofVec3d>& points,
+								 unsigned long long seed, int numCandidates ) {
+	sampleParallel<3>( min, max, radius, points, seed, numCandidates );
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofVec2d.h"
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief Fills a rectangle with random points no closer than 'radius' to
+/// each other (Poisson-disk or blue noise sampling), with Bridson's algorithm.
+///
+/// A background grid of cells small enough to hold one point each makes
+/// every distance check look at a few cells only, so the sampling is linear
+/// in the number of points. New points are tried around the existing ones
+/// until no room is left. The points are returned in grid order, and the
+/// result only depends on 'seed'.
+///
+/// ~~~~{.cpp}
+/// vector<ofVec2d> trees;
+/// ofPoissonDiskSample(ofVec2d(0, 0), ofVec2d(1000, 1000), 12, trees);
+/// ~~~~
+///
+/// \param min The lowest corner of the domain.
+/// \param max The highest corner of the domain.
+/// \param radius The smallest distance between two points.
+/// \param points Cleared, then receives the points.
+/// \param numCandidates The number of tries around every point before giving up on it.
+void ofPoissonDiskSample( const ofVec2d& min, const ofVec2d& max, double radius, std::vector<ofVec2d>& points,
+						 unsigned long long seed = 0, int numCandidates = 30 );
+
+/// \brief 3D version of ofPoissonDiskSample(), filling a box.
+void ofPoissonDiskSample( const ofVec3d& min, const ofVec3d& max, double radius, std::vector<ofVec3d>& points,
+						 unsigned long long seed = 0, int numCandidates = 30 );
+
+/// \brief Parallel version of ofPoissonDiskSample() for very large domains.
+///
+/// The grid is split into tiles coloured like a checkerboard: tiles of the
+/// same colour are too far apart to influence each other, so they are
+/// sampled concurrently, one colour after the other, each tile respecting the
+/// points of the tiles sampled before it. The result depends on 'seed' but
+/// not on the number of threads; it differs from ofPoissonDiskSample().
+void ofPoissonDiskSampleParallel( const ofVec2d& min, const ofVec2d& max, double radius, std::vector<ofVec2d>& points,
+								 unsigned long long seed = 0, int numCandidates = 30 );
+
+/// \brief 3D version of ofPoissonDiskSampleParallel().
+void ofPoissonDiskSampleParallel( const ofVec3d& min, const ofVec3d& max, double radius, std::vector<ofVec3d>& points,
+								 unsigned long long seed = 0, int numCandidates = 30 );
@@ -0,0 +1,358 @@
+#include "ofPositionBasedSolverd.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// smallest number of particles worth a thread
+const size_t PBD_PARTICLES_MIN_CHUNK = 4096;
+
+// smallest number of constraints of a batch worth a thread
+const size_t PBD_CONSTRAINTS_MIN_CHUNK = 2048;
+
+// colours tracked per particle, one bit each
+const int PBD_MAX_COLORS = 64;
+
+}
+
+
+ofPositionBasedSolverd::ofPositionBasedSolverd()
+:hasSerialBatch(false)
+,colorsDirty(true)
+,particleRadius(0)
+,gravity(0, -9.81, 0)
+,damping(0)
+,numSubsteps(10)
+,numIterations(1) {}
+
+
+// Particles.
+//
+//
+unsigned int ofPositionBasedSolverd::addParticle( const ofVec3d& position, double invMass ) {
+	positions.push_back( position );
+	previous.push_back( position );
+	velocities.push_back( ofVec3d() );
+	invMasses.push_back( invMass );
+	colorsDirty = true;
+	return (unsigned int)(positions.size() - 1);
+}
+
+size_t ofPositionBasedSolverd::getNumParticles() const {
+	return positions.size();
+}
+
+const ofVec3d& ofPositionBasedSolverd::getPosition( unsigned int particle ) const {
+	return positions[particle];
+}
+
+void ofPositionBasedSolverd::setPosition( unsigned int particle, const ofVec3d& position ) {
+	positions[particle] = position;
+}
+
+const ofVec3d& ofPositionBasedSolverd::getVelocity( unsigned int particle ) const {
+	return velocities[particle];
+}
+
+void ofPositionBasedSolverd::setVelocity( unsigned int particle, const ofVec3d& velocity ) {
+	velocities[particle] = velocity;
+}
+
+double ofPositionBasedSolverd::getInvMass( unsigned int particle ) const {
+	return invMasses[particle];
+}
+
+void ofPositionBasedSolverd::setInvMass( unsigned int particle, double invMass ) {
+	invMasses[particle] = invMass;
+}
+
+const std::vector<ofVec3d>& ofPositionBasedSolverd::getPositions() const {
+	return positions;
+}
+
+
+// Constraints.
+//
+//
+unsigned int ofPositionBasedSolverd::addDistanceConstraint( unsigned int a, unsigned int b, double restLength, double compliance ) {
+	Constraint c;
+	c.type = DISTANCE;
+	c.particles[0] = a;
+	c.particles[1] = b;
+	c.particles[2] = b;
+	c.restLength = restLength < 0 ? positions[a].distance( positions[b] ) : restLength;
+	c.compliance = compliance;
+	constraints.push_back( c );
+	lambdas.push_back( 0.0 );
+	colorsDirty = true;
+	return (unsigned int)(constraints.size() - 1);
+}
+
+unsigned int ofPositionBasedSolverd::addBendingConstraint( unsigned int a, unsigned int vertex, unsigned int b, double restLength, double compliance ) {
+	Constraint c;
+	c.type = BENDING;
+	c.particles[0] = a;
+	c.particles[1] = vertex;
+	c.particles[2] = b;
+	if( restLength < 0 ) {
+		ofVec3d center = (positions[a] + positions[vertex] + positions[b]) / 3.0;
+		restLength = positions[vertex].distance( center );
+	}
+	c.restLength = restLength;
+	c.compliance = compliance;
+	constraints.push_back( c );
+	lambdas.push_back( 0.0 );
+	colorsDirty = true;
+	return (unsigned int)(constraints.size() - 1);
+}
+
+size_t ofPositionBasedSolverd::getNumConstraints() const {
+	return constraints.size();
+}
+
+size_t ofPositionBasedSolverd::getNumBatches() const {
+	return batchOffsets.empty() ? 0 : batchOffsets.size() - 1;
+}
+
+// Greedy colouring: every constraint takes the smallest colour none of its
+// particles is already part of. The constraints are then grouped by colour.
+void ofPositionBasedSolverd::colorConstraints() {
+	const size_t num = constraints.size();
+	std::vector<unsigned long long> used( positions.size(), 0 );
+	std::vector<int> colors( num );
+	int numColors = 0;
+	hasSerialBatch = false;
+	for( size_t i=0; i<num; i++ ) {
+		const unsigned int* p = constraints[i].particles;
+		unsigned long long mask = used[p[0]] | used[p[1]] | used[p[2]];
+		int color = 0;
+		while( color < PBD_MAX_COLORS && (mask & (1ULL << color)) ) {
+			color++;
+		}
+		if( color == PBD_MAX_COLORS ) {
+			hasSerialBatch = true;
+		} else {
+			unsigned long long bit = 1ULL << color;
+			used[p[0]] |= bit;
+			used[p[1]] |= bit;
+			used[p[2]] |= bit;
+			numColors = MAX( numColors, color + 1 );
+		}
+		colors[i] = color;
+	}
+	// the serial batch goes last
+	const int numBatches = numColors + (hasSerialBatch ? 1 : 0);
+	for( size_t i=0; i<num; i++ ) {
+		if( colors[i] == PBD_MAX_COLORS ) {
+			colors[i] = numColors;
+		}
+	}
+
+	batchOffsets.assign( numBatches + 1, 0 );
+	for( size_t i=0; i<num; i++ ) {
+		batchOffsets[colors[i] + 1]++;
+	}
+	for( int b=0; b<numBatches; b++ ) {
+		batchOffsets[b + 1] += batchOffsets[b];
+	}
+	batchConstraints.resize( num );
+	std::vector<size_t> cursor( batchOffsets.begin(), batchOffsets.end() - 1 );
+	for( size_t i=0; i<num; i++ ) {
+		batchConstraints[cursor[colors[i]]++] = (unsigned int)i;
+	}
+	colorsDirty = false;
+}
+
+// Projects one constraint, 'alpha' is the compliance scale 1/h².
+void ofPositionBasedSolverd::solveConstraint( unsigned int index, double alpha ) {
+	const Constraint& c = constraints[index];
+	const double alphaTilde = c.compliance * alpha;
+	if( c.type == DISTANCE ) {
+		ofVec3d& pa = positions[c.particles[0]];
+		ofVec3d& pb = positions[c.particles[1]];
+		const double wa = invMasses[c.particles[0]];
+		const double wb = invMasses[c.particles[1]];
+		ofVec3d d = pa - pb;
+		double len = d.length();
+		double w = wa + wb;
+		if( w == 0 || len == 0 ) {
+			return;
+		}
+		ofVec3d n = d / len;
+		double C = len - c.restLength;
+		double dLambda = (-C - alphaTilde * lambdas[index]) / (w + alphaTilde);
+		lambdas[index] += dLambda;
+		pa += n * (wa * dLambda);
+		pb -= n * (wb * dLambda);
+	} else {
+		// C = |v - centre| - rest, the gradient is 2/3 n for the vertex and -1/3 n for the others
+		ofVec3d& pa = positions[c.particles[0]];
+		ofVec3d& pv = positions[c.particles[1]];
+		ofVec3d& pb = positions[c.particles[2]];
+		const double wa = invMasses[c.particles[0]];
+		const double wv = invMasses[c.particles[1]];
+		const double wb = invMasses[c.particles[2]];
+		ofVec3d d = pv - (pa + pv + pb) / 3.0;
+		double len = d.length();
+		double w = (4.0 * wv + wa + wb) / 9.0;
+		if( w == 0 || len == 0 ) {
+			return;
+		}
+		ofVec3d n = d / len;
+		double C = len - c.restLength;
+		double dLambda = (-C - alphaTilde * lambdas[index]) / (w + alphaTilde);
+		lambdas[index] += dLambda;
+		pv += n * (wv * dLambda * 2.0 / 3.0);
+		pa -= n * (wa * dLambda / 3.0);
+		pb -= n * (wb * dLambda / 3.0);
+	}
+}
+
+
+// Colliders.
+//
+//
+void ofPositionBasedSolverd::addPlaneCollider( const ofVec3d& normal, double distance ) {
+	double len = normal.length();
+	planes.push_back( ofVec4d( normal.x / len, normal.y / len, normal.z / len, distance / len ) );
+}
+
+void ofPositionBasedSolverd::addSphereCollider( const ofVec3d& center, double radius ) {
+	spheres.push_back( ofVec4d( center.x, center.y, center.z, radius ) );
+}
+
+void ofPositionBasedSolverd::clearColliders() {
+	planes.clear();
+	spheres.clear();
+}
+
+void ofPositionBasedSolverd::setParticleRadius( double radius ) {
+	particleRadius = radius;
+}
+
+// Pushes the particles [begin, end) out of the colliders.
+void ofPositionBasedSolverd::solveCollisions( size_t begin, size_t end ) {
+	for( size_t i=begin; i<end; i++ ) {
+		if( invMasses[i] == 0 ) {
+			continue;
+		}
+		ofVec3d& p = positions[i];
+		for( size_t k=0; k<planes.size(); k++ ) {
+			const ofVec4d& plane = planes[k];
+			double s = plane.x*p.x + plane.y*p.y + plane.z*p.z + plane.w - particleRadius;
+			if( s < 0 ) {
+				p.x -= plane.x * s;
+				p.y -= plane.y * s;
+				p.z -= plane.z * s;
+			}
+		}
+		for( size_t k=0; k<spheres.size(); k++ ) {
+			const ofVec4d& sphere = spheres[k];
+			ofVec3d d( p.x - sphere.x, p.y - sphere.y, p.z - sphere.z );
+			double len2 = d.lengthSquared();
+			double r = sphere.w + particleRadius;
+			if( len2 < r * r && len2 > 0 ) {
+				p = ofVec3d( sphere.x, sphere.y, sphere.z ) + d * (r / sqrt( len2 ));
+			}
+		}
+	}
+}
+
+
+// Simulation.
+//
+//
+void ofPositionBasedSolverd::setGravity( const ofVec3d& _gravity ) {
+	gravity = _gravity;
+}
+
+const ofVec3d& ofPositionBasedSolverd::getGravity() const {
+	return gravity;
+}
+
+void ofPositionBasedSolverd::setDamping( double _damping ) {
+	damping = _damping;
+}
+
+void ofPositionBasedSolverd::setNumSubsteps( int _numSubsteps ) {
+	numSubsteps = MAX( _numSubsteps, 1 );
+}
+
+void ofPositionBasedSolverd::setNumIterations( int _numIterations ) {
+	numIterations = MAX( _numIterations, 1 );
+}
+
+void ofPositionBasedSolverd::update( double dt ) {
+	const size_t num = positions.size();
+	if( num == 0 || dt <= 0 ) {
+		return;
+	}
+	if( colorsDirty ) {
+		colorConstraints();
+	}
+	const double h = dt / numSubsteps;
+	const double alpha = 1.0 / (h * h);
+	const double keep = MAX( 0.0, 1.0 - damping * h );
+	const size_t numBatches = getNumBatches();
+	const bool hasColliders = !planes.empty() || !spheres.empty();
+
+	for( int step=0; step<numSubsteps; step++ ) {
+		// predict
+		ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+			for( size_t i=begin; i<end; i++ ) {
+				previous[i] = positions[i];
+				if( invMasses[i] != 0 ) {
+					velocities[i] += gravity * h;
+					positions[i] += velocities[i] * h;
+				}
+			}
+		}, PBD_PARTICLES_MIN_CHUNK );
+		std::fill( lambdas.begin(), lambdas.end(), 0.0 );
+
+		// project, one batch after the other
+		for( int iteration=0; iteration<numIterations; iteration++ ) {
+			for( size_t b=0; b<numBatches; b++ ) {
+				const size_t first = batchOffsets[b], last = batchOffsets[b + 1];
+				if( hasSerialBatch && b + 1 == numBatches ) {
+					for( size_t i=first; i<last; i++ ) {
+						solveConstraint( batchConstraints[i], alpha );
+					}
+				} else {
+					ofParallelFor( first, last, [&]( size_t begin, size_t end ) {
+						for( size_t i=begin; i<end; i++ ) {
+							solveConstraint( batchConstraints[i], alpha );
+						}
+					}, PBD_CONSTRAINTS_MIN_CHUNK );
+				}
+			}
+			if( hasColliders ) {
+				ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+					solveCollisions( begin, end );
+				}, PBD_PARTICLES_MIN_CHUNK );
+			}
+		}
+
+		// velocities from the corrected positions
+		ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+			for( size_t i=begin; i<end; i++ ) {
+				if( invMasses[i] != 0 ) {
+					velocities[i] = (positions[i] - previous[i]) * (keep / h);
+				}
+			}
+		}, PBD_PARTICLES_MIN_CHUNK );
+	}
+}
+
+void ofPositionBasedSolverd::clear() {
+	positions.clear();
+	previous.clear();
+	velocities.clear();
+	invMasses.clear();
+	constraints.clear();
+	lambdas.clear();
+	batchConstraints.clear();
+	batchOffsets.clear();
+	hasSerialBatch = false;
+	colorsDirty = true;
+}
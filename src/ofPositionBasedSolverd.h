@@ -0,0 +1,144 @@
+#pragma once
+
+#include "ofVec3d.h"
+#include "ofVec4d.h"
+
+#include <vector>
+
+/// \brief ofPositionBasedSolverd simulates particles linked by constraints with
+/// extended position based dynamics (XPBD), for cloth, ropes and soft bodies.
+///
+/// Constraints are projected in batches that never share a particle: they are
+/// greedily graph coloured when the constraints change, and every colour is
+/// then solved in parallel with the same result as a serial Gauss–Seidel pass.
+/// Each step is divided into substeps with a single iteration each by default,
+/// which converges better than many iterations of one large step.
+///
+/// ~~~~{.cpp}
+/// ofPositionBasedSolverd cloth;
+/// for( int y = 0; y < n; y++ ) {
+///     for( int x = 0; x < n; x++ ) {
+///         // pin the top row
+///         cloth.addParticle(ofVec3d(x, 0, y) * spacing, y == 0 ? 0 : 1);
+///     }
+/// }
+/// for( int y = 0; y < n; y++ ) {
+///     for( int x = 0; x < n; x++ ) {
+///         if( x + 1 < n ) cloth.addDistanceConstraint(y*n + x, y*n + x+1);
+///         if( y + 1 < n ) cloth.addDistanceConstraint(y*n + x, (y+1)*n + x);
+///     }
+/// }
+/// cloth.addSphereCollider(ofVec3d(0, -2, 0), 1);
+/// // every frame
+/// cloth.update(1.0 / 60);
+/// ~~~~
+class ofPositionBasedSolverd {
+public:
+	ofPositionBasedSolverd();
+
+	/// \brief Adds a particle and returns its index.
+	///
+	/// \param invMass Inverse of the mass, 0 for a fixed particle.
+	unsigned int addParticle( const ofVec3d& position, double invMass = 1.0 );
+	size_t getNumParticles() const;
+
+	const ofVec3d& getPosition( unsigned int particle ) const;
+	void setPosition( unsigned int particle, const ofVec3d& position );
+	const ofVec3d& getVelocity( unsigned int particle ) const;
+	void setVelocity( unsigned int particle, const ofVec3d& velocity );
+	double getInvMass( unsigned int particle ) const;
+	void setInvMass( unsigned int particle, double invMass );
+
+	/// \brief Returns every particle position, in the order they were added.
+	const std::vector<ofVec3d>& getPositions() const;
+
+	/// \brief Keeps two particles at 'restLength' from each other.
+	///
+	/// \param restLength The length to keep, a negative value uses the current distance.
+	/// \param compliance Inverse of the stiffness, 0 for a rigid constraint.
+	/// \returns The index of the constraint.
+	unsigned int addDistanceConstraint( unsigned int a, unsigned int b, double restLength = -1, double compliance = 0 );
+
+	/// \brief Resists bending at 'vertex' between its two neighbours 'a' and 'b',
+	/// by keeping the vertex at a distance of the centre of the triangle they form.
+	///
+	/// \param restLength The distance to keep, a negative value uses the current one.
+	/// \param compliance Inverse of the stiffness, 0 for a rigid constraint.
+	/// \returns The index of the constraint.
+	unsigned int addBendingConstraint( unsigned int a, unsigned int vertex, unsigned int b, double restLength = -1, double compliance = 0 );
+
+	size_t getNumConstraints() const;
+
+	/// \brief Returns the number of batches the constraints were coloured into
+	/// by the last update().
+	size_t getNumBatches() const;
+
+	/// \brief Keeps particles on the positive side of the plane 'normal'·p + 'distance' = 0.
+	void addPlaneCollider( const ofVec3d& normal, double distance );
+
+	/// \brief Keeps particles outside a sphere.
+	void addSphereCollider( const ofVec3d& center, double radius );
+
+	void clearColliders();
+
+	/// \brief Sets the distance particles keep from the colliders, 0 by default.
+	void setParticleRadius( double radius );
+
+	void setGravity( const ofVec3d& gravity );
+	const ofVec3d& getGravity() const;
+
+	/// \brief Sets the fraction of velocity lost every second, 0 by default.
+	void setDamping( double damping );
+
+	/// \brief Sets how many substeps update() divides the time step into, 10 by default.
+	void setNumSubsteps( int numSubsteps );
+
+	/// \brief Sets how many times the constraints are projected per substep, 1 by default.
+	void setNumIterations( int numIterations );
+
+	/// \brief Advances the simulation by 'dt' seconds.
+	void update( double dt );
+
+	void clear();
+
+private:
+	enum ConstraintType {
+		DISTANCE,
+		BENDING
+	};
+
+	struct Constraint {
+		ConstraintType type;
+		unsigned int particles[3];
+		double restLength;
+		double compliance;
+	};
+
+	void colorConstraints();
+	void solveConstraint( unsigned int constraint, double alpha );
+	void solveCollisions( size_t begin, size_t end );
+
+	std::vector<ofVec3d> positions;
+	std::vector<ofVec3d> previous;
+	std::vector<ofVec3d> velocities;
+	std::vector<double> invMasses;
+
+	std::vector<Constraint> constraints;
+	// accumulated Lagrange multiplier of each constraint over a substep
+	std::vector<double> lambdas;
+	// constraint indices sorted by colour, batch b is [batchOffsets[b], batchOffsets[b+1])
+	std::vector<unsigned int> batchConstraints;
+	std::vector<size_t> batchOffsets;
+	// the last batch holds the constraints left when colours run out, it is solved serially
+	bool hasSerialBatch;
+	bool colorsDirty;
+
+	std::vector<ofVec4d> planes;
+	std::vector<ofVec4d> spheres;
+	double particleRadius;
+
+	ofVec3d gravity;
+	double damping;
+	int numSubsteps;
+	int numIterations;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+/// \brief ofQuaterniond is a double precision rotation, following the
+/// conventions of ofQuaternion.
+///
+/// Like ofQuaternion, 'a * b' is the rotation 'a' followed by 'b', and
+/// 'q * v' rotates the vector 'v'. Angles are in degrees.
+///
+/// ~~~~{.cpp}
+/// ofQuaterniond yaw(90, ofVec3d(0, 1, 0));
+/// ofQuaterniond pitch(30, ofVec3d(1, 0, 0));
+/// ofVec3d forward = (yaw * pitch) * ofVec3d(0, 0, -1); // yaw, then pitch
+/// ~~~~
+class ofQuaterniond {
+public:
+	double x, y, z, w;
+
+	/// \brief Builds the identity rotation.
+	ofQuaterniond();
+	ofQuaterniond( double x, double y, double z, double w );
+	/// \brief Builds a rotation of 'angle' degrees around 'axis'.
+	ofQuaterniond( double angle, const ofVec3d& axis );
+
+	void set( double x, double y, double z, double w );
+
+	/// \brief Makes a rotation of 'angle' degrees around 'axis'.
+	void makeRotate( double angle, const ofVec3d& axis );
+
+	/// \brief Makes the shortest rotation taking direction 'from' to direction 'to'.
+	void makeRotate( const ofVec3d& from, const ofVec3d& to );
+
+	/// \brief Returns the angle in degrees and the unit axis of the rotation.
+	void getRotate( double& angle, ofVec3d& axis ) const;
+
+	bool zeroRotation() const;
+
+	double length() const;
+	double length2() const;
+	ofQuaterniond& normalize();
+
+	/// \brief Returns the conjugate, the inverse rotation of a unit quaternion.
+	ofQuaterniond conj() const;
+	ofQuaterniond inverse() const;
+
+	/// \brief Spherical linear interpolation from 'from' (t = 0) to 'to' (t = 1).
+	void slerp( double t, const ofQuaterniond& from, const ofQuaterniond& to );
+
+	/// \brief Returns the rotation of this quaternion followed by 'q'.
+	ofQuaterniond operator*( const ofQuaterniond& q ) const;
+	ofQuaterniond& operator*=( const ofQuaterniond& q );
+
+	/// \brief Returns 'v' rotated.
+	ofVec3d operator*( const ofVec3d& v ) const;
+
+	bool operator==( const ofQuaterniond& q ) const;
+	bool operator!=( const ofQuaterniond& q ) const;
+};
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofQuaterniond::ofQuaterniond():x(0), y(0), z(0), w(1) {}
+inline ofQuaterniond::ofQuaterniond( double _x, double _y, double _z, double _w ):x(_x), y(_y), z(_z), w(_w) {}
+
+inline ofQuaterniond::ofQuaterniond( double angle, const ofVec3d& axis ) {
+	makeRotate( angle, axis );
+}
+
+inline void ofQuaterniond::set( double _x, double _y, double _z, double _w ) {
+	x = _x;
+	y = _y;
+	z = _z;
+	w = _w;
+}
+
+
+// Rotations.
+//
+//
+inline void ofQuaterniond::makeRotate( double angle, const ofVec3d& axis ) {
+	const double len = axis.length();
+	if( len < 1e-300 ) {
+		set( 0, 0, 0, 1 );
+		return;
+	}
+	const double half = angle * DEG_TO_RAD * 0.5;
+	const double s = sin( half ) / len;
+	set( axis.x * s, axis.y * s, axis.z * s, cos( half ) );
+}
+
+inline void ofQuaterniond::makeRotate( const ofVec3d& from, const ofVec3d& to ) {
+	const ofVec3d a = from.getNormalized();
+	const ofVec3d b = to.getNormalized();
+	const double d = a.dot( b );
+	if( d < -1.0 + 1e-12 ) {
+		// opposite directions: half a turn around any perpendicular axis
+		ofVec3d axis = ofVec3d( 1, 0, 0 ).getCrossed( a );
+		if( axis.lengthSquared() < 1e-12 ) {
+			axis = ofVec3d( 0, 1, 0 ).getCrossed( a );
+		}
+		makeRotate( 180, axis );
+		return;
+	}
+	const ofVec3d c = a.getCrossed( b );
+	set( c.x, c.y, c.z, 1.0 + d );
+	normalize();
+}
+
+inline void ofQuaterniond::getRotate( double& angle, ofVec3d& axis ) const {
+	const double s = sqrt( x*x + y*y + z*z );
+	angle = 2.0 * atan2( s, w ) * RAD_TO_DEG;
+	if( s > 1e-300 ) {
+		axis.set( x / s, y / s, z / s );
+	} else {
+		axis.set( 0, 0, 1 );
+	}
+}
+
+inline bool ofQuaterniond::zeroRotation() const {
+	return x == 0 && y == 0 && z == 0 && w == 1;
+}
+
+
+// Length.
+//
+//
+inline double ofQuaterniond::length() const {
+	return sqrt( length2() );
+}
+
+inline double ofQuaterniond::length2() const {
+	return x*x + y*y + z*z + w*w;
+}
+
+inline ofQuaterniond& ofQuaterniond::normalize() {
+	const double len = length();
+	if( len > 0 ) {
+		x /= len;
+		y /= len;
+		z /= len;
+		w /= len;
+	}
+	return *this;
+}
+
+inline ofQuaterniond ofQuaterniond::conj() const {
+	return ofQuaterniond( -x, -y, -z, w );
+}
+
+inline ofQuaterniond ofQuaterniond::inverse() const {
+	const double len2 = length2();
+	return ofQuaterniond( -x / len2, -y / len2, -z / len2, w / len2 );
+}
+
+inline void ofQuaterniond::slerp( double t, const ofQuaterniond& from, const ofQuaterniond& to ) {
+	double cosOmega = from.x*to.x + from.y*to.y + from.z*to.z + from.w*to.w;
+	ofQuaterniond target = to;
+	if( cosOmega < 0 ) {
+		// the shorter way round
+		cosOmega = -cosOmega;
+		target.set( -to.x, -to.y, -to.z, -to.w );
+	}
+	double a, b;
+	if( cosOmega < 1.0 - 1e-9 ) {
+		const double omega = acos( cosOmega );
+		const double sinOmega = sin( omega );
+		a = sin( (1.0 - t) * omega ) / sinOmega;
+		b = sin( t * omega ) / sinOmega;
+	} else {
+		a = 1.0 - t;
+		b = t;
+	}
+	set( from.x * a + target.x * b, from.y * a + target.y * b, from.z * a + target.z * b, from.w * a + target.w * b );
+}
+
+
+// Operators.
+//
+//
+inline ofQuaterniond ofQuaterniond::operator*( const ofQuaterniond& q ) const {
+	return ofQuaterniond( q.w*x + q.x*w + q.y*z - q.z*y,
+						 q.w*y - q.x*z + q.y*w + q.z*x,
+						 q.w*z + q.x*y - q.y*x + q.z*w,
+						 q.w*w - q.x*x - q.y*y - q.z*z );
+}
+
+inline ofQuaterniond& ofQuaterniond::operator*=( const ofQuaterniond& q ) {
+	*this = *this * q;
+	return *this;
+}
+
+inline ofVec3d ofQuaterniond::operator*( const ofVec3d& v ) const {
+	// v + 2w (u x v) + 2 u x (u x v), with u the vector part
+	const ofVec3d u( x, y, z );
+	const ofVec3d uv = u.getCrossed( v );
+	const ofVec3d uuv = u.getCrossed( uv );
+	return v + (uv * w + uuv) * 2.0;
+}
+
+inline bool ofQuaterniond::operator==( const ofQuaterniond& q ) const {
+	return x == q.x && y == q.y && z == q.z && w == q.w;
+}
+
+inline bool ofQuaterniond::operator!=( const ofQuaterniond& q ) const {
+	return !(*this == q);
+}
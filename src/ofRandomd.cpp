@@ -0,0 +1,277 @@
+#include "ofRandomd.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of values worth a thread
+const size_t RANDOM_MIN_CHUNK = 16384;
+
+// Philox4x32 multipliers and Weyl sequence constants for the key schedule
+const unsigned int PHILOX_M0 = 0xD2511F53u;
+const unsigned int PHILOX_M1 = 0xCD9E8D57u;
+const unsigned int PHILOX_W0 = 0x9E3779B9u;
+const unsigned int PHILOX_W1 = 0xBB67AE85u;
+const int PHILOX_ROUNDS = 10;
+
+inline void philox( const unsigned int counter[4], const unsigned int key[2], unsigned int out[4] ) {
+	unsigned int c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	unsigned int k0 = key[0], k1 = key[1];
+	for( int round=0; round<PHILOX_ROUNDS; round++ ) {
+		unsigned long long p0 = (unsigned long long)PHILOX_M0 * c0;
+		unsigned long long p1 = (unsigned long long)PHILOX_M1 * c2;
+		unsigned int hi0 = (unsigned int)(p0 >> 32), lo0 = (unsigned int)p0;
+		unsigned int hi1 = (unsigned int)(p1 >> 32), lo1 = (unsigned int)p1;
+		c0 = hi1 ^ c1 ^ k0;
+		c1 = lo1;
+		c2 = hi0 ^ c3 ^ k1;
+		c3 = lo0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+// double in [0, 1) from the 53 high bits of two words
+inline double toUniform( unsigned int lo, unsigned int hi ) {
+	unsigned long long bits = ((unsigned long long)hi << 32) | lo;
+	return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Uniforms of 'numBlocks' consecutive blocks, two per block.
+inline void getUniforms( const ofRandomGeneratord& rng, unsigned long long counter, int numBlocks, double* u ) {
+	for( int b=0; b<numBlocks; b++ ) {
+		unsigned int bits[4];
+		rng.getBlock( counter + b, bits );
+		u[b * 2] = toUniform( bits[0], bits[1] );
+		u[b * 2 + 1] = toUniform( bits[2], bits[3] );
+	}
+}
+
+// Two independent normal values from two uniforms (Box–Muller).
+inline void toGaussian( double u1, double u2, double& g1, double& g2 ) {
+	double r = sqrt( -2.0 * log( 1.0 - u1 ) );
+	double a = TWO_PI * u2;
+	g1 = r * cos( a );
+	g2 = r * sin( a );
+}
+
+// Element i of 'out' is fn(uniforms of blocks base + i * numBlocks ...).
+template<int numBlocks, class T, class Function>
+void generate( const ofRandomGeneratord& rng, unsigned long long base, T* out, size_t num, Function fn ) {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		double u[numBlocks * 2];
+		for( size_t i=begin; i<end; i++ ) {
+			getUniforms( rng, base + (unsigned long long)i * numBlocks, numBlocks, u );
+			out[i] = fn( u );
+		}
+	}, RANDOM_MIN_CHUNK );
+}
+
+// The distributions, from the uniforms of one or two blocks.
+inline ofVec2d onCircle( const double* u, double radius ) {
+	double a = TWO_PI * u[0];
+	return ofVec2d( cos( a ) * radius, sin( a ) * radius );
+}
+
+inline ofVec2d inDisk( const double* u, double radius ) {
+	return onCircle( u, radius * sqrt( u[1] ) );
+}
+
+inline ofVec3d onSphere( const double* u, double radius ) {
+	double z = 2.0 * u[0] - 1.0;
+	double r = sqrt( MAX( 1.0 - z * z, 0.0 ) );
+	double a = TWO_PI * u[1];
+	return ofVec3d( r * cos( a ), r * sin( a ), z ) * radius;
+}
+
+inline ofVec3d inBall( const double* u, double radius ) {
+	return onSphere( u, radius * cbrt( u[2] ) );
+}
+
+inline ofVec3d gaussian3d( const double* u, double stddev ) {
+	double x, y, z, unused;
+	toGaussian( u[0], u[1], x, y );
+	toGaussian( u[2], u[3], z, unused );
+	return ofVec3d( x, y, z ) * stddev;
+}
+
+}
+
+
+ofRandomGeneratord::ofRandomGeneratord( unsigned long long seed, unsigned long long stream ) {
+	setSeed( seed, stream );
+}
+
+void ofRandomGeneratord::setSeed( unsigned long long seed, unsigned long long stream ) {
+	key[0] = (unsigned int)seed;
+	key[1] = (unsigned int)(seed >> 32);
+	streamWords[0] = (unsigned int)stream;
+	streamWords[1] = (unsigned int)(stream >> 32);
+	counter = 0;
+}
+
+ofRandomGeneratord ofRandomGeneratord::getStream( unsigned long long stream ) const {
+	ofRandomGeneratord rng;
+	rng.key[0] = key[0];
+	rng.key[1] = key[1];
+	rng.streamWords[0] = (unsigned int)stream;
+	rng.streamWords[1] = (unsigned int)(stream >> 32);
+	return rng;
+}
+
+void ofRandomGeneratord::skip( unsigned long long num ) {
+	counter += num;
+}
+
+unsigned long long ofRandomGeneratord::getCounter() const {
+	return counter;
+}
+
+void ofRandomGeneratord::getBlock( unsigned long long block, unsigned int out[4] ) const {
+	const unsigned int words[4] = { (unsigned int)block, (unsigned int)(block >> 32), streamWords[0], streamWords[1] };
+	philox( words, key, out );
+}
+
+
+// One value.
+//
+//
+double ofRandomGeneratord::getUniform() {
+	double u[2];
+	getUniforms( *this, counter++, 1, u );
+	return u[0];
+}
+
+double ofRandomGeneratord::getUniform( double min, double max ) {
+	return min + (max - min) * getUniform();
+}
+
+double ofRandomGeneratord::getGaussian( double mean, double stddev ) {
+	double u[2], g1, g2;
+	getUniforms( *this, counter++, 1, u );
+	toGaussian( u[0], u[1], g1, g2 );
+	return mean + stddev * g1;
+}
+
+ofVec2d ofRandomGeneratord::getOnCircle( double radius ) {
+	double u[2];
+	getUniforms( *this, counter++, 1, u );
+	return onCircle( u, radius );
+}
+
+ofVec2d ofRandomGeneratord::getInDisk( double radius ) {
+	double u[2];
+	getUniforms( *this, counter++, 1, u );
+	return inDisk( u, radius );
+}
+
+ofVec3d ofRandomGeneratord::getOnSphere( double radius ) {
+	double u[2];
+	getUniforms( *this, counter++, 1, u );
+	return onSphere( u, radius );
+}
+
+ofVec3d ofRandomGeneratord::getInBall( double radius ) {
+	double u[4];
+	getUniforms( *this, counter, 2, u );
+	counter += 2;
+	return inBall( u, radius );
+}
+
+ofVec3d ofRandomGeneratord::getInBox( const ofVec3d& min, const ofVec3d& max ) {
+	double u[4];
+	getUniforms( *this, counter, 2, u );
+	counter += 2;
+	return min + (max - min) * ofVec3d( u[0], u[1], u[2] );
+}
+
+ofVec3d ofRandomGeneratord::getGaussian3d( double stddev ) {
+	double u[4];
+	getUniforms( *this, counter, 2, u );
+	counter += 2;
+	return gaussian3d( u, stddev );
+}
+
+
+// Batches.
+//
+//
+void ofRandomGeneratord::getUniform( double* out, size_t num, double min, double max ) {
+	// two values per block
+	const unsigned long long base = counter;
+	const size_t numBlocks = (num + 1) / 2;
+	ofParallelFor( 0, numBlocks, [&]( size_t begin, size_t end ) {
+		for( size_t b=begin; b<end; b++ ) {
+			double u[2];
+			getUniforms( *this, base + b, 1, u );
+			out[b * 2] = min + (max - min) * u[0];
+			if( b * 2 + 1 < num ) {
+				out[b * 2 + 1] = min + (max - min) * u[1];
+			}
+		}
+	}, RANDOM_MIN_CHUNK / 2 );
+	counter += numBlocks;
+}
+
+void ofRandomGeneratord::getGaussian( double* out, size_t num, double mean, double stddev ) {
+	const unsigned long long base = counter;
+	const size_t numBlocks = (num + 1) / 2;
+	ofParallelFor( 0, numBlocks, [&]( size_t begin, size_t end ) {
+		for( size_t b=begin; b<end; b++ ) {
+			double u[2], g1, g2;
+			getUniforms( *this, base + b, 1, u );
+			toGaussian( u[0], u[1], g1, g2 );
+			out[b * 2] = mean + stddev * g1;
+			if( b * 2 + 1 < num ) {
+				out[b * 2 + 1] = mean + stddev * g2;
+			}
+		}
+	}, RANDOM_MIN_CHUNK / 2 );
+	counter += numBlocks;
+}
+
+void ofRandomGeneratord::getOnCircle( ofVec2d* out, size_t num, double radius ) {
+	generate<1>( *this, counter, out, num, [&]( const double* u ) { return onCircle( u, radius ); } );
+	counter += num;
+}
+
+void ofRandomGeneratord::getInDisk( ofVec2d* out, size_t num, double radius ) {
+	generate<1>( *this, counter, out, num, [&]( const double* u ) { return inDisk( u, radius ); } );
+	counter += num;
+}
+
+void ofRandomGeneratord::getInBox( ofVec2d* out, size_t num, const ofVec2d& min, const ofVec2d& max ) {
+	const ofVec2d size = max - min;
+	generate<1>( *this, counter, out, num, [&]( const double* u ) { return min + size * ofVec2d( u[0], u[1] ); } );
+	counter += num;
+}
+
+void ofRandomGeneratord::getGaussian( ofVec2d* out, size_t num, double stddev ) {
+	generate<1>( *this, counter, out, num, [&]( const double* u ) {
+		double g1, g2;
+		toGaussian( u[0], u[1], g1, g2 );
+		return ofVec2d( g1, g2 ) * stddev;
+	});
+	counter += num;
+}
+
+void ofRandomGeneratord::getOnSphere( ofVec3d* out, size_t num, double radius ) {
+	generate<1>( *this, counter, out, num, [&]( const double* u ) { return onSphere( u, radius ); } );
+	counter += num;
+}
+
+void ofRandomGeneratord::getInBall( ofVec3d* out, size_t num, double radius ) {
+	generate<2>( *this, counter, out, num, [&]( const double* u ) { return inBall( u, radius ); } );
+	counter += num * 2;
+}
+
+void ofRandomGeneratord::getInBox( ofVec3d* out, size_t num, const ofVec3d& min, const ofVec3d& max ) {
+	const ofVec3d size = max - min;
+	generate<2>( *this, counter, out, num, [&]( const double* u ) { return min + size * ofVec3d( u[0], u[1], u[2] ); } );
+	counter += num * 2;
+}
+
+void ofRandomGeneratord::getGaussian( ofVec3d* out, size_t num, double stddev ) {
+	generate<2>( *this, counter, out, num, [&]( const double* u ) { return gaussian3d( u, stddev ); } );
+	counter += num * 2;
+}
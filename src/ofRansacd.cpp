@@ -0,0 +1,463 @@
+#include "ofRansacd.h"
+#include "ofEigen3d.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// hypotheses scored per pass over the cloud
+const size_t RANSAC_BATCH = 32;
+
+// smallest number of points worth a thread when scoring
+const size_t RANSAC_MIN_CHUNK = 16384;
+
+
+// Solves the 4x4 system 'a * x = b' with partial pivoting.
+bool solveLinear4( double a[4][4], double b[4], double x[4] ) {
+	for( int col=0; col<4; col++ ) {
+		int pivot = col;
+		for( int row=col+1; row<4; row++ ) {
+			if( fabs(a[row][col]) > fabs(a[pivot][col]) ) {
+				pivot = row;
+			}
+		}
+		if( fabs(a[pivot][col]) < 1e-300 ) {
+			return false;
+		}
+		if( pivot != col ) {
+			for( int k=0; k<4; k++ ) {
+				double tmp = a[col][k];
+				a[col][k] = a[pivot][k];
+				a[pivot][k] = tmp;
+			}
+			double tmp = b[col];
+			b[col] = b[pivot];
+			b[pivot] = tmp;
+		}
+		for( int row=col+1; row<4; row++ ) {
+			double f = a[row][col] / a[col][col];
+			for( int k=col; k<4; k++ ) {
+				a[row][k] -= f * a[col][k];
+			}
+			b[row] -= f * b[col];
+		}
+	}
+	for( int row=3; row>=0; row-- ) {
+		double sum = b[row];
+		for( int k=row+1; k<4; k++ ) {
+			sum -= a[row][k] * x[k];
+		}
+		x[row] = sum / a[row][row];
+	}
+	return true;
+}
+
+
+// Plane: normal.dot(p) + distance = 0
+struct PlaneModel {
+	static const int SAMPLE_SIZE = 3;
+
+	struct Hypothesis {
+		ofVec3d normal;
+		double distance;
+	};
+
+	static bool fromSample( const ofVec3d* s, Hypothesis& h ) {
+		ofVec3d ab = s[1] - s[0];
+		ofVec3d ac = s[2] - s[0];
+		ofVec3d n = ab.getCrossed( ac );
+		double len2 = n.lengthSquared();
+		if( len2 <= 1e-24 * ab.lengthSquared() * ac.lengthSquared() || len2 == 0.0 ) {
+			return false;
+		}
+		h.normal = n / sqrt( len2 );
+		h.distance = -h.normal.dot( s[0] );
+		return true;
+	}
+
+	static void score( const Hypothesis* hyps, size_t numHyps, const ofVec3d* points,
+					  size_t begin, size_t end, double threshold, size_t* counts ) {
+		double nx[RANSAC_BATCH], ny[RANSAC_BATCH], nz[RANSAC_BATCH], d[RANSAC_BATCH];
+		size_t c[RANSAC_BATCH];
+		for( size_t h=0; h<numHyps; h++ ) {
+			nx[h] = hyps[h].normal.x;
+			ny[h] = hyps[h].normal.y;
+			nz[h] = hyps[h].normal.z;
+			d[h] = hyps[h].distance;
+			c[h] = 0;
+		}
+		for( size_t i=begin; i<end; i++ ) {
+			const double px = points[i].x, py = points[i].y, pz = points[i].z;
+			for( size_t h=0; h<numHyps; h++ ) {
+				double dist = nx[h]*px + ny[h]*py + nz[h]*pz + d[h];
+				c[h] += fabs(dist) < threshold;
+			}
+		}
+		for( size_t h=0; h<numHyps; h++ ) {
+			counts[h] += c[h];
+		}
+	}
+
+	static bool isInlier( const Hypothesis& h, const ofVec3d& p, double threshold ) {
+		return fabs( h.normal.dot(p) + h.distance ) < threshold;
+	}
+
+	static bool fit( const ofVec3d* points, const std::vector<size_t>& inliers, Hypothesis& h ) {
+		if( inliers.size() < 3 ) {
+			return false;
+		}
+		ofVec3d centroid;
+		double covariance[3][3];
+		double eigenvalues[3];
+		ofVec3d eigenvectors[3];
+		ofComputeCovariance3d( points, &inliers[0], inliers.size(), centroid, covariance );
+		ofEigenSymmetric3d( covariance, eigenvalues, eigenvectors );
+		h.normal = eigenvectors[0];
+		h.distance = -h.normal.dot( centroid );
+		return true;
+	}
+};
+
+
+// Line: through 'point' along the unit vector 'direction'
+struct LineModel {
+	static const int SAMPLE_SIZE = 2;
+
+	struct Hypothesis {
+		ofVec3d point;
+		ofVec3d direction;
+	};
+
+	static bool fromSample( const ofVec3d* s, Hypothesis& h ) {
+		ofVec3d dir = s[1] - s[0];
+		double len2 = dir.lengthSquared();
+		if( len2 == 0.0 ) {
+			return false;
+		}
+		h.point = s[0];
+		h.direction = dir / sqrt( len2 );
+		return true;
+	}
+
+	static void score( const Hypothesis* hyps, size_t numHyps, const ofVec3d* points,
+					  size_t begin, size_t end, double threshold, size_t* counts ) {
+		double ax[RANSAC_BATCH], ay[RANSAC_BATCH], az[RANSAC_BATCH];
+		double ux[RANSAC_BATCH], uy[RANSAC_BATCH], uz[RANSAC_BATCH];
+		size_t c[RANSAC_BATCH];
+		for( size_t h=0; h<numHyps; h++ ) {
+			ax[h] = hyps[h].point.x;
+			ay[h] = hyps[h].point.y;
+			az[h] = hyps[h].point.z;
+			ux[h] = hyps[h].direction.x;
+			uy[h] = hyps[h].direction.y;
+			uz[h] = hyps[h].direction.z;
+			c[h] = 0;
+		}
+		const double threshold2 = threshold * threshold;
+		for( size_t i=begin; i<end; i++ ) {
+			const double px = points[i].x, py = points[i].y, pz = points[i].z;
+			for( size_t h=0; h<numHyps; h++ ) {
+				double dx = px - ax[h], dy = py - ay[h], dz = pz - az[h];
+				double along = dx*ux[h] + dy*uy[h] + dz*uz[h];
+				double dist2 = dx*dx + dy*dy + dz*dz - along*along;
+				c[h] += dist2 < threshold2;
+			}
+		}
+		for( size_t h=0; h<numHyps; h++ ) {
+			counts[h] += c[h];
+		}
+	}
+
+	static bool isInlier( const Hypothesis& h, const ofVec3d& p, double threshold ) {
+		ofVec3d d = p - h.point;
+		double along = d.dot( h.direction );
+		return d.lengthSquared() - along*along < threshold*threshold;
+	}
+
+	static bool fit( const ofVec3d* points, const std::vector<size_t>& inliers, Hypothesis& h ) {
+		if( inliers.size() < 2 ) {
+			return false;
+		}
+		ofVec3d centroid;
+		double covariance[3][3];
+		double eigenvalues[3];
+		ofVec3d eigenvectors[3];
+		ofComputeCovariance3d( points, &inliers[0], inliers.size(), centroid, covariance );
+		ofEigenSymmetric3d( covariance, eigenvalues, eigenvectors );
+		h.point = centroid;
+		h.direction = eigenvectors[2];
+		return true;
+	}
+};
+
+
+// Sphere: |p - center| == radius
+struct SphereModel {
+	static const int SAMPLE_SIZE = 4;
+
+	struct Hypothesis {
+		ofVec3d center;
+		double radius;
+	};
+
+	// Solves for the algebraic sphere x^2+y^2+z^2 + D*x + E*y + F*z + G = 0,
+	// with coordinates taken relative to 'origin' for precision.
+	static bool solve( double ata[4][4], double atb[4], const ofVec3d& origin, Hypothesis& h ) {
+		double x[4];
+		if( !solveLinear4( ata, atb, x ) ) {
+			return false;
+		}
+		ofVec3d c( -0.5*x[0], -0.5*x[1], -0.5*x[2] );
+		double r2 = c.lengthSquared() - x[3];
+		if( !(r2 > 0.0) ) {
+			return false;
+		}
+		h.center = origin + c;
+		h.radius = sqrt( r2 );
+		return true;
+	}
+
+	static bool fromSample( const ofVec3d* s, Hypothesis& h ) {
+		double a[4][4];
+		double b[4];
+		for( int i=0; i<4; i++ ) {
+			ofVec3d p = s[i] - s[0];
+			a[i][0] = p.x;
+			a[i][1] = p.y;
+			a[i][2] = p.z;
+			a[i][3] = 1.0;
+			b[i] = -p.lengthSquared();
+		}
+		// reject (nearly) coplanar samples
+		ofVec3d e1 = s[1] - s[0], e2 = s[2] - s[0], e3 = s[3] - s[0];
+		double volume = fabs( e1.getCrossed(e2).dot(e3) );
+		double scale = e1.length() * e2.length() * e3.length();
+		if( volume <= 1e-9 * scale ) {
+			return false;
+		}
+		return solve( a, b, s[0], h );
+	}
+
+	static void score( const Hypothesis* hyps, size_t numHyps, const ofVec3d* points,
+					  size_t begin, size_t end, double threshold, size_t* counts ) {
+		double cx[RANSAC_BATCH], cy[RANSAC_BATCH], cz[RANSAC_BATCH];
+		double inner2[RANSAC_BATCH], outer2[RANSAC_BATCH];
+		size_t c[RANSAC_BATCH];
+		for( size_t h=0; h<numHyps; h++ ) {
+			cx[h] = hyps[h].center.x;
+			cy[h] = hyps[h].center.y;
+			cz[h] = hyps[h].center.z;
+			double inner = hyps[h].radius > threshold ? hyps[h].radius - threshold : 0.0;
+			double outer = hyps[h].radius + threshold;
+			inner2[h] = inner * inner;
+			outer2[h] = outer * outer;
+			c[h] = 0;
+		}
+		for( size_t i=begin; i<end; i++ ) {
+			const double px = points[i].x, py = points[i].y, pz = points[i].z;
+			for( size_t h=0; h<numHyps; h++ ) {
+				double dx = px - cx[h], dy = py - cy[h], dz = pz - cz[h];
+				double dist2 = dx*dx + dy*dy + dz*dz;
+				c[h] += (dist2 > inner2[h]) & (dist2 < outer2[h]);
+			}
+		}
+		for( size_t h=0; h<numHyps; h++ ) {
+			counts[h] += c[h];
+		}
+	}
+
+	static bool isInlier( const Hypothesis& h, const ofVec3d& p, double threshold ) {
+		return fabs( p.distance(h.center) - h.radius ) < threshold;
+	}
+
+	static bool fit( const ofVec3d* points, const std::vector<size_t>& inliers, Hypothesis& h ) {
+		if( inliers.size() < 4 ) {
+			return false;
+		}
+		ofVec3d origin;
+		for( size_t i=0; i<inliers.size(); i++ ) {
+			origin += points[inliers[i]];
+		}
+		origin /= (double)inliers.size();
+		double ata[4][4] = { {0} };
+		double atb[4] = { 0 };
+		for( size_t i=0; i<inliers.size(); i++ ) {
+			ofVec3d p = points[inliers[i]] - origin;
+			double row[4] = { p.x, p.y, p.z, 1.0 };
+			double rhs = -p.lengthSquared();
+			for( int r=0; r<4; r++ ) {
+				for( int c=0; c<4; c++ ) {
+					ata[r][c] += row[r] * row[c];
+				}
+				atb[r] += row[r] * rhs;
+			}
+		}
+		return solve( ata, atb, origin, h );
+	}
+};
+
+
+template<class Model>
+void collectInliers( const ofVec3d* points, size_t num, const typename Model::Hypothesis& h,
+					double threshold, std::vector<size_t>& inliers ) {
+	size_t numChunks = ofGetParallelNumChunks( num, RANSAC_MIN_CHUNK );
+	std::vector< std::vector<size_t> > partial( numChunks );
+	ofParallelForChunks( num, RANSAC_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::vector<size_t>& out = partial[chunk];
+		for( size_t i=begin; i<end; i++ ) {
+			if( Model::isInlier( h, points[i], threshold ) ) {
+				out.push_back( i );
+			}
+		}
+	});
+	size_t total = 0;
+	for( size_t i=0; i<numChunks; i++ ) {
+		total += partial[i].size();
+	}
+	inliers.clear();
+	inliers.reserve( total );
+	for( size_t i=0; i<numChunks; i++ ) {
+		inliers.insert( inliers.end(), partial[i].begin(), partial[i].end() );
+	}
+}
+
+
+template<class Model>
+bool runRansac( const ofVec3d* points, size_t num, const ofRansacSettings& settings,
+			   typename Model::Hypothesis& best, std::vector<size_t>& inliers ) {
+	typedef typename Model::Hypothesis Hypothesis;
+	const int S = Model::SAMPLE_SIZE;
+
+	inliers.clear();
+	if( points == NULL || num < (size_t)S ) {
+		return false;
+	}
+
+	// sampling stays on the calling thread so results do not depend on the thread count
+	std::mt19937_64 rng( settings.seed );
+	std::uniform_int_distribution<size_t> pick( 0, num - 1 );
+
+	size_t numChunks = ofGetParallelNumChunks( num, RANSAC_MIN_CHUNK );
+	std::vector<size_t> counts( numChunks * RANSAC_BATCH );
+
+	size_t required = settings.maxIterations;
+	size_t tested = 0;
+	size_t bestCount = 0;
+	bool found = false;
+	// within [0, 1) so the number of hypotheses below is never negative
+	const double confidence = CLAMP( settings.confidence, 0.0, 0.999999999 );
+
+	while( tested < required ) {
+		Hypothesis hyps[RANSAC_BATCH];
+		size_t numHyps = 0;
+		while( numHyps < RANSAC_BATCH && tested < required ) {
+			tested++;
+			size_t idx[S];
+			ofVec3d sample[S];
+			for( int k=0; k<S; k++ ) {
+				bool unique;
+				do {
+					idx[k] = pick( rng );
+					unique = true;
+					for( int j=0; j<k; j++ ) {
+						unique = unique && idx[j] != idx[k];
+					}
+				} while( !unique );
+				sample[k] = points[idx[k]];
+			}
+			if( Model::fromSample( sample, hyps[numHyps] ) ) {
+				numHyps++;
+			}
+		}
+		if( numHyps == 0 ) {
+			continue;
+		}
+
+		std::fill( counts.begin(), counts.end(), 0 );
+		ofParallelForChunks( num, RANSAC_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+			Model::score( hyps, numHyps, points, begin, end, settings.distanceThreshold,
+						 &counts[chunk * RANSAC_BATCH] );
+		});
+
+		for( size_t h=0; h<numHyps; h++ ) {
+			size_t total = 0;
+			for( size_t c=0; c<numChunks; c++ ) {
+				total += counts[c * RANSAC_BATCH + h];
+			}
+			if( total > bestCount ) {
+				bestCount = total;
+				best = hyps[h];
+				found = true;
+			}
+		}
+
+		// early termination: enough hypotheses for the requested confidence
+		if( bestCount > 0 ) {
+			double allInliers = pow( (double)bestCount / (double)num, (double)S );
+			if( allInliers >= 1.0 ) {
+				required = tested;
+			} else if( allInliers > 0.0 ) {
+				double n = ceil( log(1.0 - confidence) / log(1.0 - allInliers) );
+				if( n < (double)required ) {
+					required = (size_t)n;
+				}
+			}
+		}
+	}
+
+	if( !found ) {
+		return false;
+	}
+
+	collectInliers<Model>( points, num, best, settings.distanceThreshold, inliers );
+	if( settings.refine ) {
+		Hypothesis refined;
+		if( Model::fit( points, inliers, refined ) ) {
+			std::vector<size_t> refinedInliers;
+			collectInliers<Model>( points, num, refined, settings.distanceThreshold, refinedInliers );
+			if( refinedInliers.size() >= inliers.size() ) {
+				best = refined;
+				inliers.swap( refinedInliers );
+			}
+		}
+	}
+	return inliers.size() >= settings.minInliers;
+}
+
+}
+
+
+bool ofFitPlaneRansac( const ofVec3d* points, size_t num, ofRansacPlaned& result,
+					  const ofRansacSettings& settings ) {
+	PlaneModel::Hypothesis best;
+	bool ok = runRansac<PlaneModel>( points, num, settings, best, result.inliers );
+	if( !result.inliers.empty() ) {
+		result.normal = best.normal;
+		result.distance = best.distance;
+	}
+	return ok;
+}
+
+bool ofFitLineRansac( const ofVec3d* points, size_t num, ofRansacLined& result,
+					 const ofRansacSettings& settings ) {
+	LineModel::Hypothesis best;
+	bool ok = runRansac<LineModel>( points, num, settings, best, result.inliers );
+	if( !result.inliers.empty() ) {
+		result.point = best.point;
+		result.direction = best.direction;
+	}
+	return ok;
+}
+
+bool ofFitSphereRansac( const ofVec3d* points, size_t num, ofRansacSphered& result,
+					   const ofRansacSettings& settings ) {
+	SphereModel::Hypothesis best;
+	bool ok = runRansac<SphereModel>( points, num, settings, best, result.inliers );
+	if( !result.inliers.empty() ) {
+		result.center = best.center;
+		result.radius = best.radius;
+	}
+	return ok;
+}
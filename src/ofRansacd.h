@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief Settings shared by the RANSAC shape fitters.
+///
+/// ~~~~{.cpp}
+/// ofRansacSettings settings;
+/// settings.distanceThreshold = 0.02; // 2cm
+/// settings.confidence = 0.999;
+/// ofRansacPlaned plane;
+/// if( ofFitPlaneRansac(cloud.data(), cloud.size(), plane, settings) ) {
+///     // plane.inliers holds the indices of the points on the plane
+/// }
+/// ~~~~
+struct ofRansacSettings {
+	ofRansacSettings();
+
+	/// \brief Maximum distance from a point to the shape to count as an inlier.
+	double distanceThreshold;
+
+	/// \brief Upper bound on the number of hypotheses tested.
+	size_t maxIterations;
+
+	/// \brief Probability of having drawn at least one outlier free sample
+	/// after which the search stops early, clamped between 0 and 1.
+	double confidence;
+
+	/// \brief Fits with fewer inliers than this are reported as failures.
+	size_t minInliers;
+
+	/// \brief Refine the best hypothesis with a least-squares fit to its inliers.
+	bool refine;
+
+	/// \brief Seed of the sampling; the same seed gives the same result
+	/// regardless of the number of threads.
+	unsigned long long seed;
+};
+
+/// \brief A plane fitted by ofFitPlaneRansac(). Points 'p' on the plane
+/// satisfy 'normal.dot(p) + distance == 0'.
+struct ofRansacPlaned {
+	ofVec3d normal;
+	double distance;
+	std::vector<size_t> inliers;
+};
+
+/// \brief A line fitted by ofFitLineRansac(), through 'point' along the unit
+/// vector 'direction'.
+struct ofRansacLined {
+	ofVec3d point;
+	ofVec3d direction;
+	std::vector<size_t> inliers;
+};
+
+/// \brief A sphere fitted by ofFitSphereRansac().
+struct ofRansacSphered {
+	ofVec3d center;
+	double radius;
+	std::vector<size_t> inliers;
+};
+
+/// \brief Finds the plane supported by the most points of a cloud.
+///
+/// Hypotheses are tested in batches: each pass over the points (split across
+/// threads) scores a whole batch with the 'dot()' distance, so the cloud is
+/// streamed once per batch instead of once per hypothesis. The search stops as
+/// soon as 'settings.confidence' is reached.
+///
+/// \param points The array of points.
+/// \param num The number of points in the array.
+/// \param result Receives the plane and the indices of its inliers, sorted.
+/// \returns true if a plane with at least 'settings.minInliers' inliers was found.
+bool ofFitPlaneRansac( const ofVec3d* points, size_t num, ofRansacPlaned& result,
+					  const ofRansacSettings& settings = ofRansacSettings() );
+
+/// \brief Finds the line supported by the most points of a cloud.
+/// \sa ofFitPlaneRansac()
+bool ofFitLineRansac( const ofVec3d* points, size_t num, ofRansacLined& result,
+					 const ofRansacSettings& settings = ofRansacSettings() );
+
+/// \brief Finds the sphere supported by the most points of a cloud.
+/// \sa ofFitPlaneRansac()
+bool ofFitSphereRansac( const ofVec3d* points, size_t num, ofRansacSphered& result,
+					   const ofRansacSettings& settings = ofRansacSettings() );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofRansacSettings::ofRansacSettings()
+:distanceThreshold(0.01)
+,maxIterations(1000)
+,confidence(0.99)
+,minInliers(3)
+,refine(true)
+,seed(0) {}
@@ -0,0 +1,111 @@
+#include "ofRayTriangled.h"
+#include "ofVecXdParallel.h"
+
+#include <limits>
+#include <vector>
+
+namespace {
+
+// smallest number of tests worth a thread
+const size_t RAY_MIN_CHUNK = 16384;
+
+// Möller–Trumbore without branches: every output is written, misses get an infinite distance.
+inline void intersect( const ofVec3d& o, const ofVec3d& d,
+					  const ofVec3d& a, const ofVec3d& b, const ofVec3d& c, bool cullBackFaces,
+					  double& tOut, double& uOut, double& vOut ) {
+	const double e1x = b.x - a.x, e1y = b.y - a.y, e1z = b.z - a.z;
+	const double e2x = c.x - a.x, e2y = c.y - a.y, e2z = c.z - a.z;
+	const double px = d.y*e2z - d.z*e2y;
+	const double py = d.z*e2x - d.x*e2z;
+	const double pz = d.x*e2y - d.y*e2x;
+	const double det = e1x*px + e1y*py + e1z*pz;
+	const double inv = 1.0 / det;
+	const double sx = o.x - a.x, sy = o.y - a.y, sz = o.z - a.z;
+	const double u = (sx*px + sy*py + sz*pz) * inv;
+	const double qx = sy*e1z - sz*e1y;
+	const double qy = sz*e1x - sx*e1z;
+	const double qz = sx*e1y - sy*e1x;
+	const double v = (d.x*qx + d.y*qy + d.z*qz) * inv;
+	const double t = (e2x*qx + e2y*qy + e2z*qz) * inv;
+	const bool facing = cullBackFaces ? det > 0.0 : det != 0.0;
+	const bool hit = facing & (u >= 0.0) & (v >= 0.0) & (u + v <= 1.0) & (t >= 0.0);
+	tOut = hit ? t : std::numeric_limits<double>::infinity();
+	uOut = u;
+	vOut = v;
+}
+
+}
+
+
+void ofIntersectRayTriangles( const ofRayd& ray, const ofVec3d* vertices, size_t numTriangles,
+							 double* t, double* u, double* v, bool cullBackFaces ) {
+	ofParallelFor( 0, numTriangles, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			double hu, hv;
+			intersect( ray.origin, ray.direction, vertices[i*3], vertices[i*3 + 1], vertices[i*3 + 2],
+					  cullBackFaces, t[i], hu, hv );
+			if( u ) u[i] = hu;
+			if( v ) v[i] = hv;
+		}
+	}, RAY_MIN_CHUNK );
+}
+
+void ofIntersectRayTriangles( const ofRayd& ray, const ofVec3d* positions, const unsigned int* indices,
+							 size_t numTriangles, double* t, double* u, double* v, bool cullBackFaces ) {
+	ofParallelFor( 0, numTriangles, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			double hu, hv;
+			intersect( ray.origin, ray.direction,
+					  positions[indices[i*3]], positions[indices[i*3 + 1]], positions[indices[i*3 + 2]],
+					  cullBackFaces, t[i], hu, hv );
+			if( u ) u[i] = hu;
+			if( v ) v[i] = hv;
+		}
+	}, RAY_MIN_CHUNK );
+}
+
+void ofIntersectRaysTriangle( const ofRayd* rays, size_t numRays,
+							 const ofVec3d& a, const ofVec3d& b, const ofVec3d& c,
+							 double* t, double* u, double* v, bool cullBackFaces ) {
+	ofParallelFor( 0, numRays, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			double hu, hv;
+			intersect( rays[i].origin, rays[i].direction, a, b, c, cullBackFaces, t[i], hu, hv );
+			if( u ) u[i] = hu;
+			if( v ) v[i] = hv;
+		}
+	}, RAY_MIN_CHUNK );
+}
+
+bool ofIntersectRayClosest( const ofRayd& ray, const ofVec3d* vertices, size_t numTriangles,
+						   ofRayHitd& hit, bool cullBackFaces ) {
+	const double infinity = std::numeric_limits<double>::infinity();
+	size_t numChunks = ofGetParallelNumChunks( numTriangles, RAY_MIN_CHUNK );
+	std::vector<ofRayHitd> closest( numChunks );
+	ofParallelForChunks( numTriangles, RAY_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		ofRayHitd best;
+		best.t = infinity;
+		best.u = best.v = 0;
+		best.triangle = 0;
+		for( size_t i=begin; i<end; i++ ) {
+			double t, u, v;
+			intersect( ray.origin, ray.direction, vertices[i*3], vertices[i*3 + 1], vertices[i*3 + 2],
+					  cullBackFaces, t, u, v );
+			if( t < best.t ) {
+				best.t = t;
+				best.u = u;
+				best.v = v;
+				best.triangle = i;
+			}
+		}
+		closest[chunk] = best;
+	});
+	bool found = false;
+	for( size_t c=0; c<numChunks; c++ ) {
+		if( closest[c].t < infinity && (!found || closest[c].t < hit.t) ) {
+			hit = closest[c];
+			found = true;
+		}
+	}
+	return found;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+/// \brief A half line starting at 'origin' going along 'direction'.
+///
+/// 'direction' does not need to be normalized; hit distances are then
+/// measured in multiples of its length.
+struct ofRayd {
+	ofRayd();
+	ofRayd( const ofVec3d& origin, const ofVec3d& direction );
+
+	/// \brief Returns 'origin + direction * t'.
+	ofVec3d getPoint( double t ) const;
+
+	ofVec3d origin;
+	ofVec3d direction;
+};
+
+/// \brief The closest intersection found by ofIntersectRayClosest().
+struct ofRayHitd {
+	/// \brief Distance along the ray.
+	double t;
+	/// \brief Barycentric coordinates: the hit point is 'a*(1-u-v) + b*u + c*v'.
+	double u, v;
+	/// \brief Index of the triangle that was hit.
+	size_t triangle;
+};
+
+/// \brief Intersects one ray with many triangles (Möller–Trumbore).
+///
+/// The triangles are given as a soup: triangle 'i' is 'vertices[3*i]',
+/// 'vertices[3*i+1]' and 'vertices[3*i+2]'. The loop has no early exit and
+/// no branch per triangle so it can be vectorized, and large batches are
+/// split across threads.
+///
+/// ~~~~{.cpp}
+/// vector<double> t(numTriangles);
+/// ofIntersectRayTriangles(ray, soup.data(), numTriangles, t.data());
+/// // t[i] is infinite where triangle i is missed
+/// ~~~~
+///
+/// \param t Receives the hit distance per triangle, +infinity when missed.
+/// \param u Optional, receives the barycentric coordinate of the second vertex.
+/// \param v Optional, receives the barycentric coordinate of the third vertex.
+/// \param cullBackFaces Ignore triangles seen from behind (clockwise).
+void ofIntersectRayTriangles( const ofRayd& ray, const ofVec3d* vertices, size_t numTriangles,
+							 double* t, double* u = NULL, double* v = NULL, bool cullBackFaces = false );
+
+/// \brief Intersects one ray with the triangles of an indexed mesh.
+/// \sa ofIntersectRayTriangles()
+void ofIntersectRayTriangles( const ofRayd& ray, const ofVec3d* positions, const unsigned int* indices,
+							 size_t numTriangles, double* t, double* u = NULL, double* v = NULL,
+							 bool cullBackFaces = false );
+
+/// \brief Intersects many rays with one triangle 'a', 'b', 'c'.
+/// \sa ofIntersectRayTriangles()
+void ofIntersectRaysTriangle( const ofRayd* rays, size_t numRays,
+							 const ofVec3d& a, const ofVec3d& b, const ofVec3d& c,
+							 double* t, double* u = NULL, double* v = NULL, bool cullBackFaces = false );
+
+/// \brief Finds the closest triangle of a soup hit by a ray.
+///
+/// \returns false when no triangle is hit.
+bool ofIntersectRayClosest( const ofRayd& ray, const ofVec3d* vertices, size_t numTriangles,
+						   ofRayHitd& hit, bool cullBackFaces = false );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofRayd::ofRayd() {}
+
+inline ofRayd::ofRayd( const ofVec3d& _origin, const ofVec3d& _direction )
+:origin(_origin)
+,direction(_direction) {}
+
+inline ofVec3d ofRayd::getPoint( double t ) const {
+	return origin + direction * t;
+}
@@ -0,0 +1,261 @@
+#include "ofSphd.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// smallest number of particles worth a thread
+const size_t SPH_MIN_CHUNK = 1024;
+
+// cell coordinates are packed on 21 bits each
+const int SPH_CELL_BITS = 21;
+const long long SPH_CELL_OFFSET = 1LL << (SPH_CELL_BITS - 1);
+
+inline long long getCellCoordinate( double v, double invCellSize ) {
+	long long c = (long long)floor( v * invCellSize ) + SPH_CELL_OFFSET;
+	return MIN( MAX( c, 0LL ), (1LL << SPH_CELL_BITS) - 1 );
+}
+
+inline unsigned long long getCellKey( long long x, long long y, long long z ) {
+	return ((unsigned long long)x << (2 * SPH_CELL_BITS)) | ((unsigned long long)y << SPH_CELL_BITS) | (unsigned long long)z;
+}
+
+// per thread buffers the neighbours of one particle are gathered into, so the
+// kernel sums are plain loops over arrays
+struct SphGather {
+	std::vector<double> dx, dy, dz, r2;
+
+	void gather( const ofVec3d* positions, const ofVec3d& p, const unsigned int* neighbors, unsigned int num ) {
+		if( dx.size() < num ) {
+			dx.resize( num ); dy.resize( num ); dz.resize( num ); r2.resize( num );
+		}
+		for( unsigned int k=0; k<num; k++ ) {
+			const ofVec3d& q = positions[neighbors[k]];
+			double x = p.x - q.x, y = p.y - q.y, z = p.z - q.z;
+			dx[k] = x; dy[k] = y; dz[k] = z;
+			r2[k] = x*x + y*y + z*z;
+		}
+	}
+};
+
+}
+
+
+// Neighbour list.
+//
+//
+ofSphNeighborListd::ofSphNeighborListd()
+:skin(0) {}
+
+void ofSphNeighborListd::build( const ofVec3d* positions, size_t num, double radius, double _skin ) {
+	skin = _skin;
+	builtPositions.assign( positions, positions + num );
+	begins.assign( num, 0 );
+	counts.assign( num, 0 );
+	neighbors.clear();
+	if( num == 0 ) {
+		return;
+	}
+
+	const double searchRadius = radius + skin;
+	const double searchRadius2 = searchRadius * searchRadius;
+	const double invCellSize = 1.0 / searchRadius;
+
+	// sort the particles by cell
+	std::vector< std::pair<unsigned long long, unsigned int> > sorted( num );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const ofVec3d& p = positions[i];
+			unsigned long long key = getCellKey( getCellCoordinate( p.x, invCellSize ), getCellCoordinate( p.y, invCellSize ), getCellCoordinate( p.z, invCellSize ) );
+			sorted[i] = std::make_pair( key, (unsigned int)i );
+		}
+	}, SPH_MIN_CHUNK );
+	std::sort( sorted.begin(), sorted.end() );
+
+	std::vector<unsigned long long> cellKeys;
+	std::vector<size_t> cellStarts;
+	for( size_t s=0; s<num; s++ ) {
+		if( s == 0 || sorted[s].first != sorted[s - 1].first ) {
+			cellKeys.push_back( sorted[s].first );
+			cellStarts.push_back( s );
+		}
+	}
+	cellStarts.push_back( num );
+
+	// every chunk of sorted particles fills its own list, then they are concatenated
+	const size_t numChunks = ofGetParallelNumChunks( num, SPH_MIN_CHUNK );
+	std::vector< std::vector<unsigned int> > partial( numChunks );
+	ofParallelForChunks( num, SPH_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::vector<unsigned int>& out = partial[chunk];
+		// ranges of sorted particles in the 27 cells around the current cell
+		size_t rangeBegin[27], rangeEnd[27];
+		int numRanges = 0;
+		unsigned long long currentKey = ~0ULL;
+		for( size_t s=begin; s<end; s++ ) {
+			const unsigned int i = sorted[s].second;
+			if( sorted[s].first != currentKey ) {
+				currentKey = sorted[s].first;
+				const long long mask = (1LL << SPH_CELL_BITS) - 1;
+				long long cx = (long long)(currentKey >> (2 * SPH_CELL_BITS)) & mask;
+				long long cy = (long long)(currentKey >> SPH_CELL_BITS) & mask;
+				long long cz = (long long)currentKey & mask;
+				numRanges = 0;
+				for( long long x=cx-1; x<=cx+1; x++ ) {
+					for( long long y=cy-1; y<=cy+1; y++ ) {
+						for( long long z=cz-1; z<=cz+1; z++ ) {
+							if( x < 0 || y < 0 || z < 0 || x > mask || y > mask || z > mask ) {
+								continue;
+							}
+							unsigned long long key = getCellKey( x, y, z );
+							std::vector<unsigned long long>::const_iterator it = std::lower_bound( cellKeys.begin(), cellKeys.end(), key );
+							if( it != cellKeys.end() && *it == key ) {
+								size_t cell = it - cellKeys.begin();
+								rangeBegin[numRanges] = cellStarts[cell];
+								rangeEnd[numRanges] = cellStarts[cell + 1];
+								numRanges++;
+							}
+						}
+					}
+				}
+			}
+			const ofVec3d& p = positions[i];
+			begins[i] = out.size();
+			for( int r=0; r<numRanges; r++ ) {
+				for( size_t t=rangeBegin[r]; t<rangeEnd[r]; t++ ) {
+					const unsigned int j = sorted[t].second;
+					if( j != i && p.squareDistance( positions[j] ) <= searchRadius2 ) {
+						out.push_back( j );
+					}
+				}
+			}
+			counts[i] = (unsigned int)(out.size() - begins[i]);
+		}
+	});
+
+	std::vector<size_t> chunkOffsets( numChunks + 1, 0 );
+	for( size_t c=0; c<numChunks; c++ ) {
+		chunkOffsets[c + 1] = chunkOffsets[c] + partial[c].size();
+	}
+	neighbors.resize( chunkOffsets[numChunks] );
+	ofParallelForChunks( num, SPH_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::copy( partial[chunk].begin(), partial[chunk].end(), neighbors.begin() + chunkOffsets[chunk] );
+		for( size_t s=begin; s<end; s++ ) {
+			begins[sorted[s].second] += chunkOffsets[chunk];
+		}
+	});
+}
+
+bool ofSphNeighborListd::needsRebuild( const ofVec3d* positions, size_t num ) const {
+	if( num != builtPositions.size() || num == 0 ) {
+		return true;
+	}
+	const double limit2 = skin * skin * 0.25;
+	const size_t numChunks = ofGetParallelNumChunks( num, SPH_MIN_CHUNK );
+	std::vector<char> moved( numChunks, 0 );
+	ofParallelForChunks( num, SPH_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			if( positions[i].squareDistance( builtPositions[i] ) > limit2 ) {
+				moved[chunk] = 1;
+				return;
+			}
+		}
+	});
+	return std::find( moved.begin(), moved.end(), 1 ) != moved.end();
+}
+
+void ofSphNeighborListd::clear() {
+	builtPositions.clear();
+	begins.clear();
+	counts.clear();
+	neighbors.clear();
+}
+
+size_t ofSphNeighborListd::size() const {
+	return counts.size();
+}
+
+const unsigned int* ofSphNeighborListd::getNeighbors( size_t i ) const {
+	return neighbors.empty() ? NULL : &neighbors[begins[i]];
+}
+
+unsigned int ofSphNeighborListd::getNumNeighbors( size_t i ) const {
+	return counts[i];
+}
+
+
+// Fluid.
+//
+//
+void ofComputeSphDensities( const ofSphNeighborListd& neighbors, const ofVec3d* positions, size_t num,
+						   const ofSphSettings& settings, double* densities ) {
+	const ofSphKernelsd kernels( settings.smoothingLength );
+	const double self = kernels.poly6( 0 );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		SphGather g;
+		for( size_t i=begin; i<end; i++ ) {
+			const unsigned int n = neighbors.getNumNeighbors( i );
+			g.gather( positions, positions[i], neighbors.getNeighbors( i ), n );
+			const double* r2 = g.r2.empty() ? NULL : &g.r2[0];
+			double sum = self;
+			for( unsigned int k=0; k<n; k++ ) {
+				sum += kernels.poly6( r2[k] );
+			}
+			densities[i] = sum * settings.mass;
+		}
+	}, SPH_MIN_CHUNK );
+}
+
+void ofComputeSphAccelerations( const ofSphNeighborListd& neighbors, const ofVec3d* positions, const ofVec3d* velocities,
+							   const double* densities, size_t num, const ofSphSettings& settings, ofVec3d* accelerations ) {
+	const ofSphKernelsd kernels( settings.smoothingLength );
+	const double h = settings.smoothingLength;
+	const double m = settings.mass;
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		SphGather g;
+		std::vector<double> pressureScale, viscosityScale, dvx, dvy, dvz;
+		for( size_t i=begin; i<end; i++ ) {
+			const unsigned int n = neighbors.getNumNeighbors( i );
+			const unsigned int* list = neighbors.getNeighbors( i );
+			g.gather( positions, positions[i], list, n );
+			if( pressureScale.size() < n ) {
+				pressureScale.resize( n );
+				viscosityScale.resize( n );
+				dvx.resize( n ); dvy.resize( n ); dvz.resize( n );
+			}
+			const double rho = densities[i];
+			const double pressure = settings.stiffness * (rho - settings.restDensity);
+
+			// per neighbour factors, the only gather from the other arrays
+			const ofVec3d& v = velocities[i];
+			for( unsigned int k=0; k<n; k++ ) {
+				const unsigned int j = list[k];
+				const double rhoJ = densities[j];
+				const double pressureJ = settings.stiffness * (rhoJ - settings.restDensity);
+				pressureScale[k] = -m * (pressure + pressureJ) / (2.0 * rhoJ);
+				viscosityScale[k] = settings.viscosity * m / rhoJ;
+				const ofVec3d& vj = velocities[j];
+				dvx[k] = vj.x - v.x;
+				dvy[k] = vj.y - v.y;
+				dvz[k] = vj.z - v.z;
+			}
+
+			// kernel sums over contiguous arrays
+			double ax = 0, ay = 0, az = 0, lx = 0, ly = 0, lz = 0;
+			for( unsigned int k=0; k<n; k++ ) {
+				double r = sqrt( g.r2[k] );
+				double inside = r > 0 && r < h ? 1.0 : 0.0;
+				double grad = inside * pressureScale[k] * kernels.spikyGradient( r > 0 ? r : h );
+				ax += g.dx[k] * grad;
+				ay += g.dy[k] * grad;
+				az += g.dz[k] * grad;
+				double lap = inside * viscosityScale[k] * kernels.viscosityLaplacian( r );
+				lx += dvx[k] * lap;
+				ly += dvy[k] * lap;
+				lz += dvz[k] * lap;
+			}
+			const double invRho = 1.0 / rho;
+			accelerations[i].set( (ax + lx) * invRho, (ay + ly) * invRho, (az + lz) * invRho );
+		}
+	}, SPH_MIN_CHUNK );
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief ofSphKernelsd evaluates the standard smoothed particle hydrodynamics
+/// kernels (Müller et al. 2003) for a smoothing length 'h'.
+///
+/// The normalization constants are computed once by setup(), so evaluating a
+/// kernel is a handful of multiplications.
+class ofSphKernelsd {
+public:
+	ofSphKernelsd();
+	ofSphKernelsd( double h );
+
+	void setup( double h );
+	double getSmoothingLength() const;
+
+	/// \brief Poly6 kernel, from the squared distance 'r2'. Used for densities.
+	double poly6( double r2 ) const;
+
+	/// \brief Factor of the spiky kernel gradient at distance 'r' (> 0), the
+	/// gradient for the offset 'd' of length 'r' is d * spikyGradient(r).
+	/// Used for pressure forces.
+	double spikyGradient( double r ) const;
+
+	/// \brief Laplacian of the viscosity kernel at distance 'r'.
+	double viscosityLaplacian( double r ) const;
+
+private:
+	double h, h2;
+	double poly6Scale, spikyScale, viscosityScale;
+};
+
+/// \brief ofSphNeighborListd finds, for every particle, the other particles
+/// within a radius.
+///
+/// The particles are sorted by grid cell so that neighbouring particles are
+/// searched together and the lists of a cell are close in memory. The search
+/// radius is enlarged by a 'skin' so the same list stays valid while no
+/// particle has moved more than half of the skin, and can be reused across
+/// substeps: call needsRebuild() before each substep.
+///
+/// ~~~~{.cpp}
+/// ofSphNeighborListd neighbors;
+/// // every substep
+/// if( neighbors.needsRebuild(positions.data(), positions.size()) ) {
+///     neighbors.build(positions.data(), positions.size(), settings.smoothingLength, settings.smoothingLength * 0.2);
+/// }
+/// ~~~~
+class ofSphNeighborListd {
+public:
+	ofSphNeighborListd();
+
+	/// \brief Finds the neighbours of 'num' particles within 'radius' + 'skin'.
+	void build( const ofVec3d* positions, size_t num, double radius, double skin = 0 );
+
+	/// \brief Returns true if the list is empty, built for another number of
+	/// particles, or if a particle moved more than half of the skin since build().
+	bool needsRebuild( const ofVec3d* positions, size_t num ) const;
+
+	void clear();
+	size_t size() const;
+
+	/// \brief Returns the neighbours of particle 'i', not including itself.
+	const unsigned int* getNeighbors( size_t i ) const;
+	unsigned int getNumNeighbors( size_t i ) const;
+
+private:
+	std::vector<ofVec3d> builtPositions;
+	// list of particle i is neighbors[begins[i]] .. neighbors[begins[i] + counts[i] - 1]
+	std::vector<size_t> begins;
+	std::vector<unsigned int> counts;
+	std::vector<unsigned int> neighbors;
+	double skin;
+};
+
+/// \brief Parameters of the SPH fluid functions.
+struct ofSphSettings {
+	ofSphSettings();
+
+	/// \brief Kernel radius.
+	double smoothingLength;
+	/// \brief Mass of every particle.
+	double mass;
+	double restDensity;
+	/// \brief Gas constant turning density differences into pressure.
+	double stiffness;
+	double viscosity;
+};
+
+/// \brief Computes the density of every particle.
+void ofComputeSphDensities( const ofSphNeighborListd& neighbors, const ofVec3d* positions, size_t num,
+							const ofSphSettings& settings, double* densities );
+
+/// \brief Computes the pressure and viscosity accelerations of every particle
+/// from the densities of ofComputeSphDensities(). External forces such as
+/// gravity are left to the caller.
+void ofComputeSphAccelerations( const ofSphNeighborListd& neighbors, const ofVec3d* positions, const ofVec3d* velocities,
+							   const double* densities, size_t num, const ofSphSettings& settings, ofVec3d* accelerations );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofSphKernelsd::ofSphKernelsd() {
+	setup( 1.0 );
+}
+
+inline ofSphKernelsd::ofSphKernelsd( double h ) {
+	setup( h );
+}
+
+inline void ofSphKernelsd::setup( double _h ) {
+	h = _h;
+	h2 = h * h;
+	double h3 = h2 * h;
+	double h6 = h3 * h3;
+	poly6Scale = 315.0 / (64.0 * PI * h6 * h3);
+	spikyScale = -45.0 / (PI * h6);
+	viscosityScale = 45.0 / (PI * h6);
+}
+
+inline double ofSphKernelsd::getSmoothingLength() const {
+	return h;
+}
+
+inline double ofSphKernelsd::poly6( double r2 ) const {
+	double d = MAX( h2 - r2, 0.0 );
+	return poly6Scale * d * d * d;
+}
+
+inline double ofSphKernelsd::spikyGradient( double r ) const {
+	double d = MAX( h - r, 0.0 );
+	return spikyScale * d * d / r;
+}
+
+inline double ofSphKernelsd::viscosityLaplacian( double r ) const {
+	return viscosityScale * MAX( h - r, 0.0 );
+}
+
+inline ofSphSettings::ofSphSettings()
+:smoothingLength(0.1)
+,mass(0.02)
+,restDensity(1000)
+,stiffness(3)
+,viscosity(0.1) {}
@@ -0,0 +1,402 @@
+#pragma once
+
+#include "ofVec2d.h"
+#include "ofVec3d.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <vector>
+
+enum ofSplineType {
+	/// \brief Centripetal Catmull-Rom: passes through every point, without
+	/// cusps or self intersections within a segment.
+	OF_SPLINE_CATMULL_ROM,
+	/// \brief Cubic Bézier: every segment uses 4 points and shares its last
+	/// point with the next segment, so 3n+1 points make n segments.
+	OF_SPLINE_BEZIER,
+	/// \brief Uniform cubic B-spline: C² continuous, approximates the points
+	/// instead of passing through them.
+	OF_SPLINE_BSPLINE
+};
+
+/// \brief ofSpline_ is a piecewise cubic curve through or near a list of
+/// ofVec2d or ofVec3d points. Use the ofSpline2d and ofSpline3d typedefs.
+///
+/// Every segment is converted to polynomial coefficients when the points
+/// change, so evaluating the curve is a few multiply-adds per component
+/// instead of repeated interpolations. The curve is parametrized over [0, 1],
+/// every segment covering the same parameter range; buildArcLengthTable()
+/// adds a reparametrization by length for constant speed sampling.
+///
+/// The batch functions evaluate many parameters at once, split across threads.
+///
+/// ~~~~{.cpp}
+/// ofSpline3d path(OF_SPLINE_CATMULL_ROM);
+/// path.setPoints(waypoints.data(), waypoints.size());
+/// path.buildArcLengthTable();
+/// vector<ofVec3d> samples(1000);
+/// path.getEvenlySpacedPoints(samples.size(), samples.data());
+/// camera.setPosition(path.getPointAtLength(speed * time));
+/// ~~~~
+template<class Vec>
+class ofSpline_ {
+public:
+	ofSpline_( ofSplineType type = OF_SPLINE_CATMULL_ROM );
+
+	void setType( ofSplineType type );
+	ofSplineType getType() const;
+
+	/// \brief Sets the knot parametrization of Catmull-Rom splines: 0 is uniform,
+	/// 0.5 (the default) centripetal and 1 chordal.
+	void setAlpha( double alpha );
+
+	void setPoints( const Vec* points, size_t num );
+	void addPoint( const Vec& point );
+	const std::vector<Vec>& getPoints() const;
+	void clear();
+
+	/// \brief Returns the number of cubic segments the points make.
+	size_t getNumSegments() const;
+
+	/// \brief Returns the point at parameter 'u' in [0, 1].
+	Vec getPoint( double u ) const;
+
+	/// \brief Returns the derivative of the curve with respect to 'u'.
+	Vec getTangent( double u ) const;
+
+	/// \brief Evaluates the curve at 'num' parameters.
+	void getPoints( const double* u, size_t num, Vec* out ) const;
+
+	/// \brief Evaluates the tangents at 'num' parameters.
+	void getTangents( const double* u, size_t num, Vec* out ) const;
+
+	/// \brief Samples 'num' points at evenly spaced parameters, the ends included.
+	void getUniformPoints( size_t num, Vec* out ) const;
+
+	/// \brief Measures the curve for the length functions below. Call it again
+	/// after changing the points.
+	///
+	/// \param samplesPerSegment The number of intervals every segment is split into,
+	/// each measured with Gauss–Legendre quadrature.
+	void buildArcLengthTable( size_t samplesPerSegment = 16 );
+
+	/// \brief Returns the length of the curve, 0 before buildArcLengthTable().
+	double getLength() const;
+
+	/// \brief Returns the parameter at which the length along the curve is 's'.
+	double getParameterAtLength( double s ) const;
+
+	Vec getPointAtLength( double s ) const;
+
+	/// \brief Evaluates the curve at 'num' lengths along it.
+	void getPointsAtLengths( const double* s, size_t num, Vec* out ) const;
+
+	/// \brief Samples 'num' points at equal distances along the curve, the ends included.
+	void getEvenlySpacedPoints( size_t num, Vec* out ) const;
+
+private:
+	// p(t) = a + t*(b + t*(c + t*d)) for t in [0, 1]
+	struct Segment {
+		Vec a, b, c, d;
+	};
+
+	void updateSegments( size_t first );
+	size_t getSegment( double u, double& t ) const;
+	double getSpeed( double u ) const;
+	double integrateSpeed( double u0, double u1 ) const;
+
+	ofSplineType type;
+	double alpha;
+	std::vector<Vec> points;
+	std::vector<Segment> segments;
+	// cumulative lengths at the parameters k / (lengths.size() - 1)
+	std::vector<double> lengths;
+};
+
+typedef ofSpline_<ofVec2d> ofSpline2d;
+typedef ofSpline_<ofVec3d> ofSpline3d;
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+/// \cond INTERNAL
+// smallest number of samples worth a thread
+static const size_t OF_SPLINE_MIN_CHUNK = 8192;
+/// \endcond
+
+template<class Vec>
+inline ofSpline_<Vec>::ofSpline_( ofSplineType _type )
+:type(_type)
+,alpha(0.5) {}
+
+template<class Vec>
+inline void ofSpline_<Vec>::setType( ofSplineType _type ) {
+	type = _type;
+	updateSegments( 0 );
+}
+
+template<class Vec>
+inline ofSplineType ofSpline_<Vec>::getType() const {
+	return type;
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::setAlpha( double _alpha ) {
+	alpha = _alpha;
+	updateSegments( 0 );
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::setPoints( const Vec* _points, size_t num ) {
+	points.assign( _points, _points + num );
+	updateSegments( 0 );
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::addPoint( const Vec& point ) {
+	points.push_back( point );
+	// a new point changes the last segment at most
+	updateSegments( segments.empty() ? 0 : segments.size() - 1 );
+}
+
+template<class Vec>
+inline const std::vector<Vec>& ofSpline_<Vec>::getPoints() const {
+	return points;
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::clear() {
+	points.clear();
+	segments.clear();
+	lengths.clear();
+}
+
+template<class Vec>
+inline size_t ofSpline_<Vec>::getNumSegments() const {
+	return segments.size();
+}
+
+// Recomputes the coefficients of the segments from 'first' on.
+template<class Vec>
+inline void ofSpline_<Vec>::updateSegments( size_t first ) {
+	const size_t n = points.size();
+	size_t num = 0;
+	if( type == OF_SPLINE_CATMULL_ROM ) {
+		num = n >= 2 ? n - 1 : 0;
+	} else if( type == OF_SPLINE_BEZIER ) {
+		num = n >= 4 ? (n - 1) / 3 : 0;
+	} else {
+		num = n >= 4 ? n - 3 : 0;
+	}
+	segments.resize( num );
+	lengths.clear();
+	for( size_t i=first; i<num; i++ ) {
+		Segment& s = segments[i];
+		if( type == OF_SPLINE_CATMULL_ROM ) {
+			// the ends are extended with mirrored points
+			const Vec& p1 = points[i];
+			const Vec& p2 = points[i + 1];
+			Vec p0 = i > 0 ? points[i - 1] : p1 * 2.0 - p2;
+			Vec p3 = i + 2 < n ? points[i + 2] : p2 * 2.0 - p1;
+			double dt0 = pow( (p1 - p0).length(), alpha );
+			double dt1 = pow( (p2 - p1).length(), alpha );
+			double dt2 = pow( (p3 - p2).length(), alpha );
+			if( dt1 < 1e-12 ) {
+				// coincident points, the segment stays in place
+				s.a = p1;
+				s.b = s.c = s.d = Vec();
+				continue;
+			}
+			if( dt0 < 1e-12 ) dt0 = dt1;
+			if( dt2 < 1e-12 ) dt2 = dt1;
+			// Hermite tangents of the non-uniform spline, scaled to the [0, 1] segment
+			Vec m1 = ((p1 - p0) / dt0 - (p2 - p0) / (dt0 + dt1) + (p2 - p1) / dt1) * dt1;
+			Vec m2 = ((p2 - p1) / dt1 - (p3 - p1) / (dt1 + dt2) + (p3 - p2) / dt2) * dt1;
+			s.a = p1;
+			s.b = m1;
+			s.c = (p2 - p1) * 3.0 - m1 * 2.0 - m2;
+			s.d = (p1 - p2) * 2.0 + m1 + m2;
+		} else if( type == OF_SPLINE_BEZIER ) {
+			const Vec& p0 = points[i * 3];
+			const Vec& p1 = points[i * 3 + 1];
+			const Vec& p2 = points[i * 3 + 2];
+			const Vec& p3 = points[i * 3 + 3];
+			s.a = p0;
+			s.b = (p1 - p0) * 3.0;
+			s.c = (p0 - p1 * 2.0 + p2) * 3.0;
+			s.d = p3 - p0 + (p1 - p2) * 3.0;
+		} else {
+			const Vec& p0 = points[i];
+			const Vec& p1 = points[i + 1];
+			const Vec& p2 = points[i + 2];
+			const Vec& p3 = points[i + 3];
+			s.a = (p0 + p1 * 4.0 + p2) / 6.0;
+			s.b = (p2 - p0) * 0.5;
+			s.c = (p0 - p1 * 2.0 + p2) * 0.5;
+			s.d = (p3 - p0 + (p1 - p2) * 3.0) / 6.0;
+		}
+	}
+}
+
+template<class Vec>
+inline size_t ofSpline_<Vec>::getSegment( double u, double& t ) const {
+	const size_t num = segments.size();
+	double x = CLAMP( u, 0.0, 1.0 ) * num;
+	size_t i = MIN( (size_t)x, num - 1 );
+	t = x - i;
+	return i;
+}
+
+template<class Vec>
+inline Vec ofSpline_<Vec>::getPoint( double u ) const {
+	if( segments.empty() ) {
+		return points.empty() ? Vec() : points[0];
+	}
+	double t;
+	const Segment& s = segments[getSegment( u, t )];
+	return s.a + (s.b + (s.c + s.d * t) * t) * t;
+}
+
+template<class Vec>
+inline Vec ofSpline_<Vec>::getTangent( double u ) const {
+	if( segments.empty() ) {
+		return Vec();
+	}
+	double t;
+	const Segment& s = segments[getSegment( u, t )];
+	// dp/du = dp/dt * number of segments
+	return (s.b + (s.c * 2.0 + s.d * (3.0 * t)) * t) * (double)segments.size();
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::getPoints( const double* u, size_t num, Vec* out ) const {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = getPoint( u[i] );
+		}
+	}, OF_SPLINE_MIN_CHUNK );
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::getTangents( const double* u, size_t num, Vec* out ) const {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = getTangent( u[i] );
+		}
+	}, OF_SPLINE_MIN_CHUNK );
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::getUniformPoints( size_t num, Vec* out ) const {
+	const double step = num > 1 ? 1.0 / (num - 1) : 0.0;
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = getPoint( i * step );
+		}
+	}, OF_SPLINE_MIN_CHUNK );
+}
+
+
+// Arc length.
+//
+//
+template<class Vec>
+inline double ofSpline_<Vec>::getSpeed( double u ) const {
+	return getTangent( u ).length();
+}
+
+// 5 point Gauss–Legendre quadrature of the speed over [u0, u1].
+template<class Vec>
+inline double ofSpline_<Vec>::integrateSpeed( double u0, double u1 ) const {
+	static const double nodes[5] = { 0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640 };
+	static const double weights[5] = { 0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891 };
+	const double half = (u1 - u0) * 0.5;
+	const double mid = (u0 + u1) * 0.5;
+	double sum = 0;
+	for( int k=0; k<5; k++ ) {
+		sum += weights[k] * getSpeed( mid + half * nodes[k] );
+	}
+	return sum * half;
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::buildArcLengthTable( size_t samplesPerSegment ) {
+	lengths.clear();
+	if( segments.empty() ) {
+		return;
+	}
+	const size_t num = segments.size() * MAX( samplesPerSegment, (size_t)1 );
+	lengths.resize( num + 1 );
+	lengths[0] = 0;
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t k=begin; k<end; k++ ) {
+			// interval lengths for now, summed below
+			lengths[k + 1] = integrateSpeed( (double)k / num, (double)(k + 1) / num );
+		}
+	}, OF_SPLINE_MIN_CHUNK / 8 );
+	for( size_t k=0; k<num; k++ ) {
+		lengths[k + 1] += lengths[k];
+	}
+}
+
+template<class Vec>
+inline double ofSpline_<Vec>::getLength() const {
+	return lengths.empty() ? 0.0 : lengths.back();
+}
+
+template<class Vec>
+inline double ofSpline_<Vec>::getParameterAtLength( double s ) const {
+	if( lengths.size() < 2 ) {
+		return 0;
+	}
+	const size_t num = lengths.size() - 1;
+	if( s <= 0 ) {
+		return 0;
+	}
+	if( s >= lengths[num] ) {
+		return 1;
+	}
+	size_t k = std::upper_bound( lengths.begin(), lengths.end(), s ) - lengths.begin() - 1;
+	k = MIN( k, num - 1 );
+	const double u0 = (double)k / num;
+	const double u1 = (double)(k + 1) / num;
+	const double interval = lengths[k + 1] - lengths[k];
+	double u = interval > 0 ? u0 + (u1 - u0) * (s - lengths[k]) / interval : u0;
+	// Newton steps on the length within the interval
+	for( int iteration=0; iteration<2; iteration++ ) {
+		double speed = getSpeed( u );
+		if( speed <= 0 ) {
+			break;
+		}
+		u -= (lengths[k] + integrateSpeed( u0, u ) - s) / speed;
+		u = CLAMP( u, u0, u1 );
+	}
+	return u;
+}
+
+template<class Vec>
+inline Vec ofSpline_<Vec>::getPointAtLength( double s ) const {
+	return getPoint( getParameterAtLength( s ) );
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::getPointsAtLengths( const double* s, size_t num, Vec* out ) const {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = getPointAtLength( s[i] );
+		}
+	}, OF_SPLINE_MIN_CHUNK / 8 );
+}
+
+template<class Vec>
+inline void ofSpline_<Vec>::getEvenlySpacedPoints( size_t num, Vec* out ) const {
+	const double step = num > 1 ? getLength() / (num - 1) : 0.0;
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = getPointAtLength( i * step );
+		}
+	}, OF_SPLINE_MIN_CHUNK / 8 );
+}
@@ -0,0 +1,191 @@
+#include "ofSweepAndPruned.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// below this many proxies the three axes are sorted on the calling thread
+const size_t SAP_MIN_PARALLEL = 4096;
+
+// smallest number of endpoints worth a thread when sweeping
+const size_t SAP_MIN_CHUNK = 8192;
+
+}
+
+
+ofSweepAndPruned::ofSweepAndPruned()
+:numProxies(0) {}
+
+unsigned int ofSweepAndPruned::addProxy( const ofAabbd& box ) {
+	unsigned int proxy;
+	if( !freeProxies.empty() ) {
+		proxy = freeProxies.back();
+		freeProxies.pop_back();
+		boxes[proxy] = box;
+		alive[proxy] = true;
+	} else {
+		proxy = (unsigned int)boxes.size();
+		boxes.push_back( box );
+		alive.push_back( true );
+	}
+	for( int axis=0; axis<3; axis++ ) {
+		Endpoint e;
+		e.value = box.min[axis];
+		e.data = proxy * 2;
+		endpoints[axis].push_back( e );
+		e.value = box.max[axis];
+		e.data = proxy * 2 + 1;
+		endpoints[axis].push_back( e );
+	}
+	numProxies++;
+	return proxy;
+}
+
+void ofSweepAndPruned::removeProxy( unsigned int proxy ) {
+	if( proxy >= alive.size() || !alive[proxy] ) {
+		return;
+	}
+	// the endpoints are purged by the next update(), only then is the id reused
+	alive[proxy] = false;
+	removed.push_back( proxy );
+	numProxies--;
+}
+
+void ofSweepAndPruned::updateProxy( unsigned int proxy, const ofAabbd& box ) {
+	boxes[proxy] = box;
+}
+
+const ofAabbd& ofSweepAndPruned::getBox( unsigned int proxy ) const {
+	return boxes[proxy];
+}
+
+size_t ofSweepAndPruned::size() const {
+	return numProxies;
+}
+
+const std::vector< std::pair<unsigned int, unsigned int> >& ofSweepAndPruned::getOverlappingPairs() const {
+	return pairs;
+}
+
+void ofSweepAndPruned::sortAxis( int axis ) {
+	std::vector<Endpoint>& ep = endpoints[axis];
+	if( !removed.empty() ) {
+		size_t kept = 0;
+		for( size_t i=0; i<ep.size(); i++ ) {
+			if( alive[ep[i].data >> 1] ) {
+				ep[kept++] = ep[i];
+			}
+		}
+		ep.resize( kept );
+	}
+
+	// min endpoints go before max endpoints of the same value, so touching boxes overlap
+	size_t numOutOfOrder = 0;
+	for( size_t i=0; i<ep.size(); i++ ) {
+		const ofAabbd& box = boxes[ep[i].data >> 1];
+		ep[i].value = (ep[i].data & 1) ? box.max[axis] : box.min[axis];
+	}
+	for( size_t i=1; i<ep.size(); i++ ) {
+		numOutOfOrder += ep[i].value < ep[i-1].value;
+	}
+	struct Less {
+		bool operator()( const Endpoint& a, const Endpoint& b ) const {
+			return a.value < b.value || (a.value == b.value && (a.data & 1) < (b.data & 1));
+		}
+	};
+	Less less;
+
+	if( numOutOfOrder > ep.size() / 8 + 64 ) {
+		// too much changed since the last frame (first frame, teleports...)
+		std::sort( ep.begin(), ep.end(), less );
+		return;
+	}
+	// insertion sort, close to linear when the order barely changed
+	for( size_t i=1; i<ep.size(); i++ ) {
+		Endpoint e = ep[i];
+		size_t j = i;
+		while( j > 0 && less( e, ep[j-1] ) ) {
+			ep[j] = ep[j-1];
+			j--;
+		}
+		ep[j] = e;
+	}
+}
+
+int ofSweepAndPruned::getSweepAxis() const {
+	// sweep the axis where the centres vary the most, it gives the fewest candidates
+	ofVec3d sum, sum2;
+	size_t count = 0;
+	for( size_t i=0; i<boxes.size(); i++ ) {
+		if( !alive[i] ) {
+			continue;
+		}
+		ofVec3d c = boxes[i].getCenter();
+		sum += c;
+		sum2 += c * c;
+		count++;
+	}
+	if( count == 0 ) {
+		return 0;
+	}
+	ofVec3d variance = sum2 / (double)count - (sum / (double)count) * (sum / (double)count);
+	int axis = 0;
+	if( variance.y > variance[axis] ) axis = 1;
+	if( variance.z > variance[axis] ) axis = 2;
+	return axis;
+}
+
+void ofSweepAndPruned::update() {
+	if( numProxies >= SAP_MIN_PARALLEL ) {
+		ofParallelForChunks( 3, 1, [&]( size_t, size_t begin, size_t end ) {
+			for( size_t axis=begin; axis<end; axis++ ) {
+				sortAxis( (int)axis );
+			}
+		});
+	} else {
+		for( int axis=0; axis<3; axis++ ) {
+			sortAxis( axis );
+		}
+	}
+	freeProxies.insert( freeProxies.end(), removed.begin(), removed.end() );
+	removed.clear();
+
+	const int axis = getSweepAxis();
+	const int axis1 = (axis + 1) % 3;
+	const int axis2 = (axis + 2) % 3;
+	const std::vector<Endpoint>& ep = endpoints[axis];
+
+	// every min endpoint scans forward until its own max endpoint; a pair is reported
+	// by the box whose min comes first so each pair is found once
+	size_t numChunks = ofGetParallelNumChunks( ep.size(), SAP_MIN_CHUNK );
+	std::vector< std::vector< std::pair<unsigned int, unsigned int> > > partial( numChunks );
+	ofParallelForChunks( ep.size(), SAP_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::vector< std::pair<unsigned int, unsigned int> >& out = partial[chunk];
+		for( size_t i=begin; i<end; i++ ) {
+			if( ep[i].data & 1 ) {
+				continue;
+			}
+			unsigned int p = ep[i].data >> 1;
+			const unsigned int pMax = ep[i].data + 1;
+			const ofAabbd& a = boxes[p];
+			for( size_t j=i+1; j<ep.size() && ep[j].data != pMax; j++ ) {
+				if( ep[j].data & 1 ) {
+					continue;
+				}
+				unsigned int q = ep[j].data >> 1;
+				const ofAabbd& b = boxes[q];
+				if( a.min[axis1] <= b.max[axis1] && a.max[axis1] >= b.min[axis1] &&
+				   a.min[axis2] <= b.max[axis2] && a.max[axis2] >= b.min[axis2] ) {
+					out.push_back( p < q ? std::make_pair( p, q ) : std::make_pair( q, p ) );
+				}
+			}
+		}
+	});
+
+	pairs.clear();
+	for( size_t c=0; c<numChunks; c++ ) {
+		pairs.insert( pairs.end(), partial[c].begin(), partial[c].end() );
+	}
+	std::sort( pairs.begin(), pairs.end() );
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ofAabbd.h"
+
+#include <utility>
+#include <vector>
+
+/// \brief ofSweepAndPruned is an incremental sweep-and-prune broad phase over
+/// ofAabbd bounds.
+///
+/// The box endpoints are kept sorted on the three axes between updates.
+/// Objects move little from one frame to the next, so the insertion sort that
+/// restores the order does close to linear work. The three axes are sorted
+/// on separate threads, then the pairs are found by sweeping the axis where
+/// the boxes are the most spread out, testing the two other axes on the fly;
+/// the sweep itself is split across threads for large scenes.
+///
+/// ~~~~{.cpp}
+/// ofSweepAndPruned broadPhase;
+/// for( size_t i = 0; i < bodies.size(); i++ ) {
+///     bodies[i].proxy = broadPhase.addProxy(bodies[i].getBounds());
+/// }
+/// // every frame
+/// for( size_t i = 0; i < bodies.size(); i++ ) {
+///     broadPhase.updateProxy(bodies[i].proxy, bodies[i].getBounds());
+/// }
+/// broadPhase.update();
+/// const vector< pair<unsigned int, unsigned int> >& pairs = broadPhase.getOverlappingPairs();
+/// ~~~~
+class ofSweepAndPruned {
+public:
+	ofSweepAndPruned();
+
+	/// \brief Adds a box and returns its proxy id.
+	unsigned int addProxy( const ofAabbd& box );
+
+	/// \brief Removes a proxy, its id will be reused.
+	void removeProxy( unsigned int proxy );
+
+	/// \brief Changes the box of a proxy, the endpoints are re-sorted by update().
+	void updateProxy( unsigned int proxy, const ofAabbd& box );
+
+	const ofAabbd& getBox( unsigned int proxy ) const;
+
+	/// \brief Returns the number of proxies.
+	size_t size() const;
+
+	/// \brief Sorts the endpoints and finds the overlapping pairs.
+	void update();
+
+	/// \brief Returns the pairs of proxy ids found by the last update(), the
+	/// smaller id first, sorted.
+	const std::vector< std::pair<unsigned int, unsigned int> >& getOverlappingPairs() const;
+
+private:
+	struct Endpoint {
+		double value;
+		// proxy id * 2, +1 for the max endpoint
+		unsigned int data;
+	};
+
+	void sortAxis( int axis );
+	int getSweepAxis() const;
+
+	std::vector<ofAabbd> boxes;
+	std::vector<bool> alive;
+	std::vector<unsigned int> freeProxies;
+	size_t numProxies;
+
+	std::vector<Endpoint> endpoints[3];
+	std::vector<unsigned int> removed;
+
+	std::vector< std::pair<unsigned int, unsigned int> > pairs;
+};
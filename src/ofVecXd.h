@@ -2,3 +2,34 @@
 #include "ofVec3d.h"
 #include "ofVec4d.h"
 
+#include "ofVecXdParallel.h"
+#include "ofEigen3d.h"
+#include "ofRansacd.h"
+#include "ofVoxelGridd.h"
+#include "ofKdTree3d.h"
+#include "ofNormalEstimationd.h"
+#include "ofMeshNormalsd.h"
+#include "ofMeshd.h"
+#include "ofVecXdGather.h"
+#include "ofRayTriangled.h"
+#include "ofAabbd.h"
+#include "ofFrustumd.h"
+#include "ofSweepAndPruned.h"
+#include "ofDynamicAabbTreed.h"
+#include "ofParticleSystemd.h"
+#include "ofBarnesHutd.h"
+#include "ofPositionBasedSolverd.h"
+#include "ofSphd.h"
+#include "ofSplined.h"
+#include "ofKeyframeTrackd.h"
+#include "ofVecXdBlend.h"
+#include "ofVectorFieldd.h"
+#include "ofNoised.h"
+#include "ofRandomd.h"
+#include "ofPoissonDiskd.h"
+#include "ofKMeansd.h"
+#include "ofDbscand.h"
+#include "ofQuaterniond.h"
+#include "ofMatrix4x4d.h"
+#include "ofNoded.h"
+#include "ofFloatingOrigind.h"
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+#include <vector>
+
+/// \brief Interpolates two arrays: out[i] = a[i].getInterpolated(b[i], p).
+///
+/// Works with double, ofVec2d, ofVec3d and ofVec4d. The vectors are processed
+/// as one flat array of doubles, a loop the compiler turns into SIMD
+/// multiply-adds. Large batches are split across threads. 'out' may be 'a' or 'b'.
+///
+/// ~~~~{.cpp}
+/// // crossfade two poses
+/// ofGetInterpolated(poseA.data(), poseB.data(), poseA.size(), fade, pose.data());
+/// ~~~~
+template<class T>
+void ofGetInterpolated( const T* a, const T* b, size_t num, double p, T* out );
+
+/// \brief Interpolates two arrays with one amount per element:
+/// out[i] = a[i].getInterpolated(b[i], p[i]).
+template<class T>
+void ofGetInterpolated( const T* a, const T* b, const double* p, size_t num, T* out );
+
+/// \brief Moves 'a' towards 'b' in place: a[i].interpolate(b[i], p).
+template<class T>
+void ofInterpolate( T* a, const T* b, size_t num, double p );
+
+/// \brief Moves 'a' towards 'b' in place with one amount per element:
+/// a[i].interpolate(b[i], p[i]).
+template<class T>
+void ofInterpolate( T* a, const T* b, const double* p, size_t num );
+
+/// \brief Weighted sum of several arrays: out[i] = sum of weights[k] * inputs[k][i].
+///
+/// Used for morph targets and multi-way crossfades. The output is accumulated
+/// tile by tile so it stays in cache while every input is added. 'out' may not
+/// be one of the inputs.
+///
+/// ~~~~{.cpp}
+/// const ofVec3d* targets[3] = { base.data(), smile.data(), blink.data() };
+/// double weights[3] = { 1.0 - smile - blink, smile, blink };
+/// ofBlend(targets, weights, 3, base.size(), vertices.data());
+/// ~~~~
+template<class T>
+void ofBlend( const T* const* inputs, const double* weights, size_t numInputs, size_t num, T* out );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+/// \cond INTERNAL
+// smallest number of doubles worth a thread for interpolations and blends
+static const size_t OF_BLEND_MIN_CHUNK = 32768;
+
+// number of doubles a blend accumulates at once
+static const size_t OF_BLEND_TILE = 1024;
+
+// number of doubles in a T, T being double or a vector of doubles
+template<class T>
+struct ofBlendTraits {
+	static const size_t DIM = T::DIM;
+	static const double* ptr( const T* v ) { return v->getPtr(); }
+	static double* ptr( T* v ) { return v->getPtr(); }
+};
+
+template<>
+struct ofBlendTraits<double> {
+	static const size_t DIM = 1;
+	static const double* ptr( const double* v ) { return v; }
+	static double* ptr( double* v ) { return v; }
+};
+/// \endcond
+
+template<class T>
+inline void ofGetInterpolated( const T* a, const T* b, size_t num, double p, T* out ) {
+	static_assert( sizeof(T) == ofBlendTraits<T>::DIM * sizeof(double), "T must be made of doubles only" );
+	if( num == 0 ) {
+		return;
+	}
+	const double* fa = ofBlendTraits<T>::ptr( a );
+	const double* fb = ofBlendTraits<T>::ptr( b );
+	double* fo = ofBlendTraits<T>::ptr( out );
+	ofParallelFor( 0, num * ofBlendTraits<T>::DIM, [&]( size_t begin, size_t end ) {
+		for( size_t j=begin; j<end; j++ ) {
+			fo[j] = fa[j] + (fb[j] - fa[j]) * p;
+		}
+	}, OF_BLEND_MIN_CHUNK );
+}
+
+template<class T>
+inline void ofGetInterpolated( const T* a, const T* b, const double* p, size_t num, T* out ) {
+	static_assert( sizeof(T) == ofBlendTraits<T>::DIM * sizeof(double), "T must be made of doubles only" );
+	if( num == 0 ) {
+		return;
+	}
+	const size_t dim = ofBlendTraits<T>::DIM;
+	const double* fa = ofBlendTraits<T>::ptr( a );
+	const double* fb = ofBlendTraits<T>::ptr( b );
+	double* fo = ofBlendTraits<T>::ptr( out );
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const double t = p[i];
+			for( size_t c=0; c<dim; c++ ) {
+				const size_t j = i * dim + c;
+				fo[j] = fa[j] + (fb[j] - fa[j]) * t;
+			}
+		}
+	}, OF_BLEND_MIN_CHUNK / dim );
+}
+
+template<class T>
+inline void ofInterpolate( T* a, const T* b, size_t num, double p ) {
+	ofGetInterpolated( a, b, num, p, a );
+}
+
+template<class T>
+inline void ofInterpolate( T* a, const T* b, const double* p, size_t num ) {
+	ofGetInterpolated( a, b, p, num, a );
+}
+
+template<class T>
+inline void ofBlend( const T* const* inputs, const double* weights, size_t numInputs, size_t num, T* out ) {
+	static_assert( sizeof(T) == ofBlendTraits<T>::DIM * sizeof(double), "T must be made of doubles only" );
+	if( num == 0 ) {
+		return;
+	}
+	double* fo = ofBlendTraits<T>::ptr( out );
+	if( numInputs == 0 ) {
+		std::fill( fo, fo + num * ofBlendTraits<T>::DIM, 0.0 );
+		return;
+	}
+	ofParallelFor( 0, num * ofBlendTraits<T>::DIM, [&]( size_t begin, size_t end ) {
+		for( size_t tile=begin; tile<end; tile+=OF_BLEND_TILE ) {
+			const size_t tileEnd = MIN( tile + OF_BLEND_TILE, end );
+			const double* in = ofBlendTraits<T>::ptr( inputs[0] );
+			const double w0 = weights[0];
+			for( size_t j=tile; j<tileEnd; j++ ) {
+				fo[j] = in[j] * w0;
+			}
+			for( size_t k=1; k<numInputs; k++ ) {
+				const double* ink = ofBlendTraits<T>::ptr( inputs[k] );
+				const double w = weights[k];
+				for( size_t j=tile; j<tileEnd; j++ ) {
+					fo[j] += ink[j] * w;
+				}
+			}
+		}
+	}, OF_BLEND_MIN_CHUNK );
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ofVecXdParallel.h"
+
+#include <vector>
+
+/// \brief Copies 'in[indices[i]]' into 'out[i]' for i in [0, num).
+///
+/// Works with ofVec2d, ofVec3d, ofVec4d or any copyable type, and any integer
+/// index type. Large batches are split across threads.
+///
+/// ~~~~{.cpp}
+/// vector<ofVec3d> corners(indices.size());
+/// ofGather(positions.data(), indices.data(), indices.size(), corners.data());
+/// ~~~~
+template<class T, class Index>
+void ofGather( const T* in, const Index* indices, size_t num, T* out );
+
+/// \brief Copies 'in[i]' into 'out[indices[i]]' for i in [0, num).
+///
+/// The indices should be unique: when they repeat, which value ends up in
+/// 'out' depends on the threads.
+template<class T, class Index>
+void ofScatter( const T* in, const Index* indices, size_t num, T* out );
+
+/// \brief Adds 'in[i]' to 'acc[indices[i]]' for i in [0, num), on the calling thread.
+template<class T, class Index>
+void ofScatterAdd( const T* in, const Index* indices, size_t num, T* acc );
+
+/// \brief Adds 'in[i]' to 'acc[indices[i]]' for i in [0, num), using every thread.
+///
+/// The accumulators are split into one contiguous range per thread and the
+/// inputs are first bucketed by range, so each thread only writes its own
+/// accumulators: no atomics, no locks, and every accumulator receives its
+/// values in input order, giving the same result as ofScatterAdd().
+///
+/// \param numAcc The number of accumulators, every index must be smaller.
+template<class T, class Index>
+void ofScatterAddParallel( const T* in, const Index* indices, size_t num, T* acc, size_t numAcc );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+/// \cond INTERNAL
+// smallest number of elements worth a thread for gathers and scatters
+static const size_t OF_GATHER_MIN_CHUNK = 16384;
+/// \endcond
+
+template<class T, class Index>
+inline void ofGather( const T* in, const Index* indices, size_t num, T* out ) {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[i] = in[indices[i]];
+		}
+	}, OF_GATHER_MIN_CHUNK );
+}
+
+template<class T, class Index>
+inline void ofScatter( const T* in, const Index* indices, size_t num, T* out ) {
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			out[indices[i]] = in[i];
+		}
+	}, OF_GATHER_MIN_CHUNK );
+}
+
+template<class T, class Index>
+inline void ofScatterAdd( const T* in, const Index* indices, size_t num, T* acc ) {
+	for( size_t i=0; i<num; i++ ) {
+		acc[indices[i]] += in[i];
+	}
+}
+
+template<class T, class Index>
+inline void ofScatterAddParallel( const T* in, const Index* indices, size_t num, T* acc, size_t numAcc ) {
+	size_t numChunks = ofGetParallelNumChunks( num, OF_GATHER_MIN_CHUNK );
+	if( numChunks <= 1 || numAcc == 0 ) {
+		ofScatterAdd( in, indices, num, acc );
+		return;
+	}
+	// accumulator range r is [r * rangeSize, (r+1) * rangeSize)
+	const size_t numRanges = numChunks;
+	const size_t rangeSize = (numAcc + numRanges - 1) / numRanges;
+
+	// count the inputs of every chunk falling in every range
+	std::vector<size_t> counts( numChunks * numRanges, 0 );
+	ofParallelForChunks( num, OF_GATHER_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		size_t* count = &counts[chunk * numRanges];
+		for( size_t i=begin; i<end; i++ ) {
+			count[(size_t)indices[i] / rangeSize]++;
+		}
+	});
+
+	// bucket r holds the inputs of range r, chunk after chunk so input order is kept
+	std::vector<size_t> starts( numChunks * numRanges );
+	size_t total = 0;
+	for( size_t r=0; r<numRanges; r++ ) {
+		for( size_t c=0; c<numChunks; c++ ) {
+			starts[c * numRanges + r] = total;
+			total += counts[c * numRanges + r];
+		}
+	}
+	std::vector<size_t> rangeBegin( numRanges + 1 );
+	for( size_t r=0; r<numRanges; r++ ) {
+		rangeBegin[r] = starts[r];
+	}
+	rangeBegin[numRanges] = total;
+
+	std::vector<size_t> order( num );
+	ofParallelForChunks( num, OF_GATHER_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		size_t* cursor = &starts[chunk * numRanges];
+		for( size_t i=begin; i<end; i++ ) {
+			order[cursor[(size_t)indices[i] / rangeSize]++] = i;
+		}
+	});
+
+	ofParallelForChunks( numRanges, 1, [&]( size_t, size_t first, size_t last ) {
+		for( size_t r=first; r<last; r++ ) {
+			for( size_t k=rangeBegin[r]; k<rangeBegin[r + 1]; k++ ) {
+				size_t i = order[k];
+				acc[indices[i]] += in[i];
+			}
+		}
+	});
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ofConstants.h"
+
+#include <thread>
+#include <vector>
+
+/// \brief Sets the number of threads used by the batch functions of ofxVecXd.
+///
+/// Passing 0 (the default) uses std::thread::hardware_concurrency().
+///
+/// ~~~~{.cpp}
+/// ofSetVecXdNumThreads(4); // never use more than 4 threads
+/// ~~~~
+void ofSetVecXdNumThreads( unsigned int numThreads );
+
+/// \brief Returns the number of threads used by the batch functions of ofxVecXd.
+unsigned int ofGetVecXdNumThreads();
+
+/// \brief Returns the number of chunks ofParallelForChunks() will split 'num'
+/// elements into when every chunk must hold at least 'minChunk' elements.
+///
+/// Useful to allocate one accumulator per chunk before running the loop.
+size_t ofGetParallelNumChunks( size_t num, size_t minChunk );
+
+/// \brief Splits the range [0, num) into contiguous chunks and calls
+/// 'fn(chunk, begin, end)' once per chunk, each on its own thread.
+///
+/// 'chunk' goes from 0 to ofGetParallelNumChunks(num, minChunk)-1, so it can
+/// be used to index per-chunk accumulators without locking. Small ranges
+/// run on the calling thread.
+///
+/// ~~~~{.cpp}
+/// size_t numChunks = ofGetParallelNumChunks(num, 4096);
+/// vector<double> sums(numChunks, 0.0);
+/// ofParallelForChunks(num, 4096, [&](size_t chunk, size_t begin, size_t end){
+///     for(size_t i = begin; i < end; i++) sums[chunk] += values[i];
+/// });
+/// ~~~~
+template<class Function>
+void ofParallelForChunks( size_t num, size_t minChunk, Function fn );
+
+/// \brief Calls 'fn(begin, end)' on contiguous sub ranges of [begin, end),
+/// in parallel when the range is large enough.
+///
+/// \param minChunk The smallest number of elements worth a thread of its own.
+template<class Function>
+void ofParallelFor( size_t begin, size_t end, Function fn, size_t minChunk = 4096 );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+/// \cond INTERNAL
+inline unsigned int& ofVecXdNumThreadsSetting() {
+	static unsigned int numThreads = 0;
+	return numThreads;
+}
+/// \endcond
+
+inline void ofSetVecXdNumThreads( unsigned int numThreads ) {
+	ofVecXdNumThreadsSetting() = numThreads;
+}
+
+inline unsigned int ofGetVecXdNumThreads() {
+	unsigned int numThreads = ofVecXdNumThreadsSetting();
+	if( numThreads == 0 ) {
+		numThreads = std::thread::hardware_concurrency();
+	}
+	return numThreads > 0 ? numThreads : 1;
+}
+
+inline size_t ofGetParallelNumChunks( size_t num, size_t minChunk ) {
+	if( num == 0 ) {
+		return 0;
+	}
+	if( minChunk == 0 ) {
+		minChunk = 1;
+	}
+	size_t numChunks = num / minChunk;
+	if( numChunks < 1 ) {
+		numChunks = 1;
+	}
+	size_t numThreads = ofGetVecXdNumThreads();
+	return numChunks < numThreads ? numChunks : numThreads;
+}
+
+template<class Function>
+inline void ofParallelForChunks( size_t num, size_t minChunk, Function fn ) {
+	size_t numChunks = ofGetParallelNumChunks( num, minChunk );
+	if( numChunks == 0 ) {
+		return;
+	}
+	if( numChunks == 1 ) {
+		fn( size_t(0), size_t(0), num );
+		return;
+	}
+	size_t chunkSize = num / numChunks;
+	size_t remainder = num % numChunks;
+	std::vector<std::thread> threads;
+	threads.reserve( numChunks - 1 );
+	size_t begin = 0;
+	size_t firstEnd = 0;
+	for( size_t chunk = 0; chunk < numChunks; chunk++ ) {
+		size_t end = begin + chunkSize + (chunk < remainder ? 1 : 0);
+		if( chunk == 0 ) {
+			// the calling thread works on the first chunk itself
+			firstEnd = end;
+		} else {
+			threads.push_back( std::thread( fn, chunk, begin, end ) );
+		}
+		begin = end;
+	}
+	fn( size_t(0), size_t(0), firstEnd );
+	for( size_t i = 0; i < threads.size(); i++ ) {
+		threads[i].join();
+	}
+}
+
+template<class Function>
+inline void ofParallelFor( size_t begin, size_t end, Function fn, size_t minChunk ) {
+	if( end <= begin ) {
+		return;
+	}
+	ofParallelForChunks( end - begin, minChunk, [&]( size_t, size_t b, size_t e ) {
+		fn( begin + b, begin + e );
+	});
+}
@@ -0,0 +1,282 @@
+#include "ofVectorFieldd.h"
+#include "ofVecXdParallel.h"
+
+namespace {
+
+// smallest number of samples worth a thread
+const size_t FIELD_SAMPLE_MIN_CHUNK = 4096;
+
+// number of samples whose cells and weights are computed together
+const size_t FIELD_SAMPLE_BLOCK = 64;
+
+// smallest number of lines worth a thread
+const size_t FIELD_LINES_MIN_CHUNK = 16;
+
+// A grid point and the position of a sample in the cell above it, from 0 to 1
+// on every axis.
+struct FieldCell {
+	size_t index;
+	double fx, fy, fz;
+};
+
+// The cell of the trilinear interpolation at 'p', clamped to the grid.
+inline FieldCell getCell( const ofVec3d& p, const ofVec3d& origin, const ofVec3d& invSpacing, int nx, int ny, int nz ) {
+	double gx = CLAMP( (p.x - origin.x) * invSpacing.x, 0.0, nx - 1.0 );
+	double gy = CLAMP( (p.y - origin.y) * invSpacing.y, 0.0, ny - 1.0 );
+	double gz = CLAMP( (p.z - origin.z) * invSpacing.z, 0.0, nz - 1.0 );
+	int x0 = MIN( (int)gx, MAX( nx - 2, 0 ) );
+	int y0 = MIN( (int)gy, MAX( ny - 2, 0 ) );
+	int z0 = MIN( (int)gz, MAX( nz - 2, 0 ) );
+	FieldCell cell;
+	cell.index = ((size_t)z0 * ny + y0) * nx + x0;
+	cell.fx = gx - x0;
+	cell.fy = gy - y0;
+	cell.fz = gz - z0;
+	return cell;
+}
+
+// Trilinear blend of the 8 grid points of 'cell'.
+inline ofVec3d blendCell( const ofVec3d* values, const FieldCell& cell, int nx, int ny, int nz ) {
+	// offsets to the next grid point on every axis, 0 for flat grids
+	size_t dx = nx > 1 ? 1 : 0;
+	size_t dy = ny > 1 ? nx : 0;
+	size_t dz = nz > 1 ? (size_t)nx * ny : 0;
+	const ofVec3d* v = values + cell.index;
+	const double fx = cell.fx, fy = cell.fy, fz = cell.fz;
+
+	double w000 = (1 - fx) * (1 - fy) * (1 - fz), w100 = fx * (1 - fy) * (1 - fz);
+	double w010 = (1 - fx) * fy * (1 - fz), w110 = fx * fy * (1 - fz);
+	double w001 = (1 - fx) * (1 - fy) * fz, w101 = fx * (1 - fy) * fz;
+	double w011 = (1 - fx) * fy * fz, w111 = fx * fy * fz;
+	return v[0] * w000 + v[dx] * w100 + v[dy] * w010 + v[dx + dy] * w110
+		+ v[dz] * w001 + v[dx + dz] * w101 + v[dy + dz] * w011 + v[dx + dy + dz] * w111;
+}
+
+// One step of the field from 'p' at time 't', classic RK4. 'f' returns the
+// velocity at a position and time.
+template<class Velocity>
+ofVec3d stepRK4( const Velocity& f, const ofVec3d& p, double t, double h, const ofVec3d& k1 ) {
+	ofVec3d k2 = f( p + k1 * (h * 0.5), t + h * 0.5 );
+	ofVec3d k3 = f( p + k2 * (h * 0.5), t + h * 0.5 );
+	ofVec3d k4 = f( p + k3 * h, t + h );
+	return p + (k1 + (k2 + k3) * 2.0 + k4) * (h / 6.0);
+}
+
+// One step of the Dormand–Prince 5(4) pair, returns the 5th order solution
+// and the length of the difference with the 4th order one in 'error'.
+template<class Velocity>
+ofVec3d stepRK45( const Velocity& f, const ofVec3d& p, double t, double h, const ofVec3d& k1, double& error ) {
+	ofVec3d k2 = f( p + k1 * (h * (1.0/5)), t + h * (1.0/5) );
+	ofVec3d k3 = f( p + (k1 * (3.0/40) + k2 * (9.0/40)) * h, t + h * (3.0/10) );
+	ofVec3d k4 = f( p + (k1 * (44.0/45) + k2 * (-56.0/15) + k3 * (32.0/9)) * h, t + h * (4.0/5) );
+	ofVec3d k5 = f( p + (k1 * (19372.0/6561) + k2 * (-25360.0/2187) + k3 * (64448.0/6561) + k4 * (-212.0/729)) * h, t + h * (8.0/9) );
+	ofVec3d k6 = f( p + (k1 * (9017.0/3168) + k2 * (-355.0/33) + k3 * (46732.0/5247) + k4 * (49.0/176) + k5 * (-5103.0/18656)) * h, t + h );
+	ofVec3d next = p + (k1 * (35.0/384) + k3 * (500.0/1113) + k4 * (125.0/192) + k5 * (-2187.0/6784) + k6 * (11.0/84)) * h;
+	ofVec3d k7 = f( next, t + h );
+	ofVec3d delta = (k1 * (35.0/384 - 5179.0/57600) + k3 * (500.0/1113 - 7571.0/16695) + k4 * (125.0/192 - 393.0/640)
+					+ k5 * (-2187.0/6784 + 92097.0/339200) + k6 * (11.0/84 - 187.0/2100) + k7 * (-1.0/40)) * h;
+	error = delta.length();
+	return next;
+}
+
+// Integrates one line from 'seed'. 'velocity' returns the field at a position
+// and time, 'alive' tells if a position and time are still within the field.
+template<class Velocity, class Alive>
+void traceLine( const Velocity& velocity, const Alive& alive, const ofVec3d& seed, double startTime,
+			   const ofStreamlineSettings& settings, std::vector<ofVec3d>& line ) {
+	line.clear();
+	line.push_back( seed );
+	if( !alive( seed, startTime ) ) {
+		return;
+	}
+	// backward tracing runs time backwards, the steps stay positive
+	const double sign = settings.backward ? -1.0 : 1.0;
+	auto f = [&]( const ofVec3d& p, double t ) {
+		return velocity( p, startTime + sign * t ) * sign;
+	};
+	ofVec3d p = seed;
+	double t = 0;
+	double h = settings.stepSize;
+	double length = 0;
+	while( (int)line.size() < settings.maxSteps ) {
+		ofVec3d k1 = f( p, t );
+		if( k1.length() < settings.minSpeed ) {
+			break;
+		}
+		ofVec3d next;
+		double used = h;
+		if( settings.adaptive ) {
+			double error;
+			next = stepRK45( f, p, t, h, k1, error );
+			// shrink the step until the error is small enough
+			while( error > settings.tolerance && h > settings.minStepSize ) {
+				h = MAX( h * MAX( 0.9 * pow( settings.tolerance / error, 0.2 ), 0.2 ), settings.minStepSize );
+				next = stepRK45( f, p, t, h, k1, error );
+			}
+			used = h;
+			double grow = error > 0 ? 0.9 * pow( settings.tolerance / error, 0.2 ) : 5.0;
+			h = CLAMP( h * MIN( grow, 5.0 ), settings.minStepSize, settings.maxStepSize );
+		} else {
+			next = stepRK4( f, p, t, h, k1 );
+		}
+		t += used;
+		if( !alive( next, startTime + sign * t ) ) {
+			break;
+		}
+		length += next.distance( p );
+		p = next;
+		line.push_back( p );
+		if( settings.maxLength > 0 && length >= settings.maxLength ) {
+			break;
+		}
+	}
+}
+
+}
+
+
+ofVectorFieldd::ofVectorFieldd()
+:nx(0)
+,ny(0)
+,nz(0) {}
+
+void ofVectorFieldd::setup( int _nx, int _ny, int _nz, const ofVec3d& _origin, const ofVec3d& _spacing ) {
+	nx = MAX( _nx, 1 );
+	ny = MAX( _ny, 1 );
+	nz = MAX( _nz, 1 );
+	origin = _origin;
+	spacing = _spacing;
+	invSpacing.set( spacing.x != 0 ? 1.0 / spacing.x : 0.0, spacing.y != 0 ? 1.0 / spacing.y : 0.0, spacing.z != 0 ? 1.0 / spacing.z : 0.0 );
+	values.assign( (size_t)nx * ny * nz, ofVec3d() );
+}
+
+int ofVectorFieldd::getWidth() const {
+	return nx;
+}
+
+int ofVectorFieldd::getHeight() const {
+	return ny;
+}
+
+int ofVectorFieldd::getDepth() const {
+	return nz;
+}
+
+const ofVec3d& ofVectorFieldd::getOrigin() const {
+	return origin;
+}
+
+const ofVec3d& ofVectorFieldd::getSpacing() const {
+	return spacing;
+}
+
+ofVec3d ofVectorFieldd::getGridPoint( int x, int y, int z ) const {
+	return origin + ofVec3d( x * spacing.x, y * spacing.y, z * spacing.z );
+}
+
+const ofVec3d& ofVectorFieldd::getValue( int x, int y, int z ) const {
+	return values[((size_t)z * ny + y) * nx + x];
+}
+
+void ofVectorFieldd::setValue( int x, int y, int z, const ofVec3d& value ) {
+	values[((size_t)z * ny + y) * nx + x] = value;
+}
+
+std::vector<ofVec3d>& ofVectorFieldd::getValues() {
+	return values;
+}
+
+const std::vector<ofVec3d>& ofVectorFieldd::getValues() const {
+	return values;
+}
+
+bool ofVectorFieldd::isInside( const ofVec3d& p ) const {
+	if( values.empty() ) {
+		return false;
+	}
+	double gx = (p.x - origin.x) * invSpacing.x;
+	double gy = (p.y - origin.y) * invSpacing.y;
+	double gz = (p.z - origin.z) * invSpacing.z;
+	return gx >= 0 && gy >= 0 && gz >= 0 && gx <= nx - 1 && gy <= ny - 1 && gz <= nz - 1;
+}
+
+ofVec3d ofVectorFieldd::sample( const ofVec3d& p ) const {
+	if( values.empty() ) {
+		return ofVec3d();
+	}
+	return blendCell( values.data(), getCell( p, origin, invSpacing, nx, ny, nz ), nx, ny, nz );
+}
+
+void ofVectorFieldd::sample( const ofVec3d* points, size_t num, ofVec3d* out ) const {
+	if( values.empty() ) {
+		for( size_t i=0; i<num; i++ ) {
+			out[i] = ofVec3d();
+		}
+		return;
+	}
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		// cells and weights of a block first, in a loop without gathers, then
+		// the blend
+		FieldCell cells[FIELD_SAMPLE_BLOCK];
+		for( size_t first=begin; first<end; first+=FIELD_SAMPLE_BLOCK ) {
+			const size_t count = MIN( end - first, FIELD_SAMPLE_BLOCK );
+			for( size_t i=0; i<count; i++ ) {
+				cells[i] = getCell( points[first + i], origin, invSpacing, nx, ny, nz );
+			}
+			for( size_t i=0; i<count; i++ ) {
+				out[first + i] = blendCell( values.data(), cells[i], nx, ny, nz );
+			}
+		}
+	}, FIELD_SAMPLE_MIN_CHUNK );
+}
+
+
+// Lines.
+//
+//
+void ofTraceStreamlines( const ofVectorFieldd& field, const ofVec3d* seeds, size_t num,
+						const ofStreamlineSettings& settings, std::vector< std::vector<ofVec3d> >& lines ) {
+	lines.resize( num );
+	auto velocity = [&]( const ofVec3d& p, double ) {
+		return field.sample( p );
+	};
+	auto alive = [&]( const ofVec3d& p, double ) {
+		return field.isInside( p );
+	};
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			traceLine( velocity, alive, seeds[i], 0.0, settings, lines[i] );
+		}
+	}, FIELD_LINES_MIN_CHUNK );
+}
+
+void ofTracePathlines( const ofVectorFieldd* frames, size_t numFrames, double frameDuration,
+					  const ofVec3d* seeds, size_t num, double startTime,
+					  const ofStreamlineSettings& settings, std::vector< std::vector<ofVec3d> >& lines ) {
+	lines.resize( num );
+	if( numFrames == 0 ) {
+		for( size_t i=0; i<num; i++ ) {
+			lines[i].assign( 1, seeds[i] );
+		}
+		return;
+	}
+	const double endTime = (numFrames - 1) * frameDuration;
+	auto velocity = [&]( const ofVec3d& p, double t ) {
+		double u = frameDuration > 0 ? CLAMP( t / frameDuration, 0.0, numFrames - 1.0 ) : 0.0;
+		size_t f0 = MIN( (size_t)u, numFrames - 1 );
+		size_t f1 = MIN( f0 + 1, numFrames - 1 );
+		double w = u - f0;
+		ofVec3d v = frames[f0].sample( p );
+		return w > 0 ? v + (frames[f1].sample( p ) - v) * w : v;
+	};
+	// the time can go slightly past the ends to trace up to them
+	const double slack = settings.minStepSize;
+	auto alive = [&]( const ofVec3d& p, double t ) {
+		return t >= -slack && t <= endTime + slack && frames[0].isInside( p );
+	};
+	ofParallelFor( 0, num, [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			traceLine( velocity, alive, seeds[i], startTime, settings, lines[i] );
+		}
+	}, FIELD_LINES_MIN_CHUNK );
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <vector>
+
+/// \brief ofVectorFieldd is a 3D vector field sampled on a regular grid, such
+/// as a velocity field exported from a fluid simulation.
+///
+/// The values are stored x first, then y, then z. Between grid points the
+/// field is interpolated trilinearly, outside of the grid the nearest border
+/// value is used.
+///
+/// ~~~~{.cpp}
+/// ofVectorFieldd field;
+/// field.setup(64, 64, 64, ofVec3d(-1, -1, -1), ofVec3d(2.0 / 63));
+/// for( int z = 0; z < 64; z++ )
+///     for( int y = 0; y < 64; y++ )
+///         for( int x = 0; x < 64; x++ )
+///             field.setValue(x, y, z, velocityAt(field.getGridPoint(x, y, z)));
+///
+/// vector< vector<ofVec3d> > lines;
+/// ofTraceStreamlines(field, seeds.data(), seeds.size(), ofStreamlineSettings(), lines);
+/// ~~~~
+class ofVectorFieldd {
+public:
+	ofVectorFieldd();
+
+	/// \brief Allocates a grid of 'nx' x 'ny' x 'nz' zero vectors.
+	///
+	/// \param origin Position of grid point (0, 0, 0).
+	/// \param spacing Distance between neighbouring grid points on every axis.
+	void setup( int nx, int ny, int nz, const ofVec3d& origin, const ofVec3d& spacing );
+
+	int getWidth() const;
+	int getHeight() const;
+	int getDepth() const;
+	const ofVec3d& getOrigin() const;
+	const ofVec3d& getSpacing() const;
+
+	/// \brief Returns the position of a grid point.
+	ofVec3d getGridPoint( int x, int y, int z ) const;
+
+	const ofVec3d& getValue( int x, int y, int z ) const;
+	void setValue( int x, int y, int z, const ofVec3d& value );
+
+	/// \brief Returns all the values, x first, then y, then z.
+	std::vector<ofVec3d>& getValues();
+	const std::vector<ofVec3d>& getValues() const;
+
+	/// \brief Returns true if 'p' is within the box spanned by the grid points.
+	bool isInside( const ofVec3d& p ) const;
+
+	/// \brief Returns the field at 'p', interpolated trilinearly.
+	ofVec3d sample( const ofVec3d& p ) const;
+
+	/// \brief Samples the field at 'num' points, in parallel for large batches.
+	/// Cells and weights are computed by blocks of points before the values are
+	/// blended, the results are the same as sampling one point at a time.
+	void sample( const ofVec3d* points, size_t num, ofVec3d* out ) const;
+
+private:
+	int nx, ny, nz;
+	ofVec3d origin, spacing, invSpacing;
+	std::vector<ofVec3d> values;
+};
+
+/// \brief Parameters of ofTraceStreamlines() and ofTracePathlines().
+struct ofStreamlineSettings {
+	ofStreamlineSettings();
+
+	/// \brief Time step, the initial one when 'adaptive' is true.
+	double stepSize;
+	/// \brief If true, the step size follows the error estimate of an embedded
+	/// Runge–Kutta 4(5) (Dormand–Prince) pair, otherwise classic RK4 is used.
+	bool adaptive;
+	/// \brief Largest position error accepted per step by the adaptive integrator.
+	double tolerance;
+	double minStepSize;
+	double maxStepSize;
+	/// \brief Largest number of points in a line.
+	int maxSteps;
+	/// \brief Stops a line when it is longer than this, 0 for no limit.
+	double maxLength;
+	/// \brief Stops a line where the field is slower than this.
+	double minSpeed;
+	/// \brief Follows the field backwards when true.
+	bool backward;
+};
+
+/// \brief Traces one streamline of a steady field from every seed. Lines end
+/// where they leave the grid, reach a point where the field vanishes, or
+/// reach the step or length limit. The seeds are traced in parallel.
+///
+/// \param lines Resized to 'num', line i starts with seed i.
+void ofTraceStreamlines( const ofVectorFieldd& field, const ofVec3d* seeds, size_t num,
+						const ofStreamlineSettings& settings, std::vector< std::vector<ofVec3d> >& lines );
+
+/// \brief Traces the paths followed by particles released at the seeds in a
+/// field changing over time.
+///
+/// \param frames The field at times 0, 'frameDuration', 2 * 'frameDuration'...,
+/// interpolated linearly in between. Every frame must have the same grid.
+/// \param startTime The time the particles are released.
+void ofTracePathlines( const ofVectorFieldd* frames, size_t numFrames, double frameDuration,
+					  const ofVec3d* seeds, size_t num, double startTime,
+					  const ofStreamlineSettings& settings, std::vector< std::vector<ofVec3d> >& lines );
+
+
+/////////////////
+// Implementation
+/////////////////
+
+
+inline ofStreamlineSettings::ofStreamlineSettings()
+:stepSize(0.01)
+,adaptive(true)
+,tolerance(1e-6)
+,minStepSize(1e-6)
+,maxStepSize(0.1)
+,maxSteps(1000)
+,maxLength(0)
+,minSpeed(1e-9)
+,backward(false) {}
@@ -0,0 +1,204 @@
+#include "ofVoxelGridd.h"
+#include "ofVecXdParallel.h"
+
+#include <algorithm>
+
+namespace {
+
+// number of hash maps the voxels are spread over, merged by separate threads
+const size_t VOXEL_NUM_SHARDS = 64;
+
+// smallest number of points worth a thread
+const size_t VOXEL_MIN_CHUNK = 65536;
+
+inline unsigned long long mixKey( unsigned long long x, unsigned long long y, unsigned long long z ) {
+	unsigned long long h = x * 0x9E3779B97F4A7C15ULL;
+	h ^= y * 0xC2B2AE3D27D4EB4FULL;
+	h ^= z * 0x165667B19E3779F9ULL;
+	h ^= h >> 31;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	h ^= h >> 29;
+	return h;
+}
+
+inline size_t getShard( const ofVoxelDownsamplerd::Key& k ) {
+	return (size_t)(mixKey( k.x, k.y, k.z ) >> 58) % VOXEL_NUM_SHARDS;
+}
+
+inline bool isFinite( const ofVec3d& p ) {
+	return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+}
+
+
+size_t ofVoxelDownsamplerd::KeyHash::operator()( const Key& k ) const {
+	return (size_t)mixKey( k.x, k.y, k.z );
+}
+
+ofVoxelDownsamplerd::ofVoxelDownsamplerd() {
+	setup( 1.0 );
+}
+
+ofVoxelDownsamplerd::ofVoxelDownsamplerd( double _voxelSize, ofVoxelDownsampleMode _mode, const ofVec3d& _origin ) {
+	setup( _voxelSize, _mode, _origin );
+}
+
+void ofVoxelDownsamplerd::setup( double _voxelSize, ofVoxelDownsampleMode _mode, const ofVec3d& _origin ) {
+	voxelSize = _voxelSize;
+	mode = _mode;
+	origin = _origin;
+	shards.clear();
+	shards.resize( VOXEL_NUM_SHARDS );
+}
+
+void ofVoxelDownsamplerd::clear() {
+	for( size_t i=0; i<shards.size(); i++ ) {
+		shards[i].clear();
+	}
+}
+
+double ofVoxelDownsamplerd::getVoxelSize() const {
+	return voxelSize;
+}
+
+ofVoxelDownsampleMode ofVoxelDownsamplerd::getMode() const {
+	return mode;
+}
+
+const ofVec3d& ofVoxelDownsamplerd::getOrigin() const {
+	return origin;
+}
+
+size_t ofVoxelDownsamplerd::getNumVoxels() const {
+	size_t num = 0;
+	for( size_t i=0; i<shards.size(); i++ ) {
+		num += shards[i].size();
+	}
+	return num;
+}
+
+ofVoxelDownsamplerd::Key ofVoxelDownsamplerd::getKey( const ofVec3d& p ) const {
+	Key k;
+	k.x = (long long)floor( (p.x - origin.x) / voxelSize );
+	k.y = (long long)floor( (p.y - origin.y) / voxelSize );
+	k.z = (long long)floor( (p.z - origin.z) / voxelSize );
+	return k;
+}
+
+ofVec3d ofVoxelDownsamplerd::getCorner( const Key& k ) const {
+	return ofVec3d( origin.x + k.x * voxelSize,
+				   origin.y + k.y * voxelSize,
+				   origin.z + k.z * voxelSize );
+}
+
+void ofVoxelDownsamplerd::merge( Voxel& dst, const Voxel& src ) const {
+	if( mode == OF_VOXEL_CENTROID ) {
+		dst.value += src.value;
+	} else {
+		// ties are broken on the coordinates so the result does not depend on the input order
+		const ofVec3d& a = src.value;
+		const ofVec3d& b = dst.value;
+		bool smaller = a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+		if( src.distanceSquared < dst.distanceSquared ||
+		   (src.distanceSquared == dst.distanceSquared && smaller) ) {
+			dst.value = src.value;
+			dst.distanceSquared = src.distanceSquared;
+		}
+	}
+	dst.count += src.count;
+}
+
+void ofVoxelDownsamplerd::add( const ofVec3d* points, size_t num ) {
+	if( points == NULL || num == 0 || !(voxelSize > 0) ) {
+		return;
+	}
+	typedef std::pair<Key, Voxel> Entry;
+	const ofVec3d halfVoxel( voxelSize * 0.5 );
+
+	// every chunk sorts its points by voxel and reduces them to one entry per voxel,
+	// already bucketed by the shard that will receive it
+	size_t numChunks = ofGetParallelNumChunks( num, VOXEL_MIN_CHUNK );
+	std::vector< std::vector<Entry> > partial( numChunks * VOXEL_NUM_SHARDS );
+	ofParallelForChunks( num, VOXEL_MIN_CHUNK, [&]( size_t chunk, size_t begin, size_t end ) {
+		std::vector< std::pair<Key, size_t> > keyed;
+		keyed.reserve( end - begin );
+		for( size_t i=begin; i<end; i++ ) {
+			if( isFinite( points[i] ) ) {
+				keyed.push_back( std::make_pair( getKey( points[i] ), i ) );
+			}
+		}
+		std::sort( keyed.begin(), keyed.end(),
+				  []( const std::pair<Key, size_t>& a, const std::pair<Key, size_t>& b ) {
+					  return a.first < b.first;
+				  });
+		size_t i = 0;
+		while( i < keyed.size() ) {
+			const Key& key = keyed[i].first;
+			ofVec3d corner = getCorner( key );
+			Entry entry;
+			entry.first = key;
+			entry.second.value = points[keyed[i].second] - corner;
+			entry.second.distanceSquared = entry.second.value.squareDistance( halfVoxel );
+			entry.second.count = 1;
+			size_t j = i + 1;
+			for( ; j < keyed.size() && keyed[j].first == key; j++ ) {
+				Voxel v;
+				v.value = points[keyed[j].second] - corner;
+				v.distanceSquared = v.value.squareDistance( halfVoxel );
+				v.count = 1;
+				merge( entry.second, v );
+			}
+			partial[chunk * VOXEL_NUM_SHARDS + getShard( key )].push_back( entry );
+			i = j;
+		}
+	});
+
+	// each shard is owned by one thread while merging
+	ofParallelForChunks( VOXEL_NUM_SHARDS, 1, [&]( size_t, size_t begin, size_t end ) {
+		for( size_t s=begin; s<end; s++ ) {
+			std::unordered_map<Key, Voxel, KeyHash>& shard = shards[s];
+			for( size_t c=0; c<numChunks; c++ ) {
+				const std::vector<Entry>& entries = partial[c * VOXEL_NUM_SHARDS + s];
+				for( size_t e=0; e<entries.size(); e++ ) {
+					std::unordered_map<Key, Voxel, KeyHash>::iterator it = shard.find( entries[e].first );
+					if( it == shard.end() ) {
+						shard.insert( entries[e] );
+					} else {
+						merge( it->second, entries[e].second );
+					}
+				}
+			}
+		}
+	});
+}
+
+void ofVoxelDownsamplerd::getPoints( std::vector<ofVec3d>& out ) const {
+	std::vector< std::pair<Key, const Voxel*> > voxels;
+	voxels.reserve( getNumVoxels() );
+	for( size_t s=0; s<shards.size(); s++ ) {
+		std::unordered_map<Key, Voxel, KeyHash>::const_iterator it = shards[s].begin();
+		for( ; it != shards[s].end(); ++it ) {
+			voxels.push_back( std::make_pair( it->first, &it->second ) );
+		}
+	}
+	std::sort( voxels.begin(), voxels.end(),
+			  []( const std::pair<Key, const Voxel*>& a, const std::pair<Key, const Voxel*>& b ) {
+				  return a.first < b.first;
+			  });
+	out.resize( voxels.size() );
+	ofParallelFor( 0, voxels.size(), [&]( size_t begin, size_t end ) {
+		for( size_t i=begin; i<end; i++ ) {
+			const Voxel& v = *voxels[i].second;
+			ofVec3d offset = mode == OF_VOXEL_CENTROID ? v.value / (double)v.count : v.value;
+			out[i] = getCorner( voxels[i].first ) + offset;
+		}
+	});
+}
+
+void ofVoxelDownsample( const ofVec3d* points, size_t num, double voxelSize,
+					   std::vector<ofVec3d>& out, ofVoxelDownsampleMode mode ) {
+	ofVoxelDownsamplerd downsampler( voxelSize, mode );
+	downsampler.add( points, num );
+	downsampler.getPoints( out );
+}
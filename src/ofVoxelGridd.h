@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ofVec3d.h"
+
+#include <unordered_map>
+#include <vector>
+
+/// \brief How ofVoxelDownsamplerd picks the point that represents a voxel.
+enum ofVoxelDownsampleMode {
+	/// \brief The average of the points that fell into the voxel.
+	OF_VOXEL_CENTROID,
+	/// \brief The input point closest to the centre of the voxel.
+	OF_VOXEL_NEAREST_TO_CENTER
+};
+
+/// \brief ofVoxelDownsamplerd thins a point cloud to one point per voxel.
+///
+/// Points are fed in batches with add(), so clouds that do not fit in memory
+/// can be streamed from disk: memory use grows with the number of occupied
+/// voxels, not with the number of points. Each batch is split across threads,
+/// every thread sorts its points by voxel and reduces them, and the partial
+/// voxels are merged into sharded hash maps in parallel.
+///
+/// ~~~~{.cpp}
+/// ofVoxelDownsamplerd downsampler(0.05); // 5cm voxels
+/// while( reader.read(batch) ) {
+///     downsampler.add(batch.data(), batch.size());
+/// }
+/// vector<ofVec3d> thinned;
+/// downsampler.getPoints(thinned);
+/// ~~~~
+class ofVoxelDownsamplerd {
+public:
+	ofVoxelDownsamplerd();
+
+	/// \param voxelSize The edge length of the voxels.
+	/// \param mode The point kept for each voxel.
+	/// \param origin A corner of the voxel grid.
+	ofVoxelDownsamplerd( double voxelSize, ofVoxelDownsampleMode mode = OF_VOXEL_CENTROID,
+						const ofVec3d& origin = ofVec3d() );
+
+	/// \brief Clears the voxels and changes the grid.
+	void setup( double voxelSize, ofVoxelDownsampleMode mode = OF_VOXEL_CENTROID,
+			   const ofVec3d& origin = ofVec3d() );
+
+	/// \brief Adds a batch of points to the grid.
+	void add( const ofVec3d* points, size_t num );
+
+	/// \brief Returns the number of occupied voxels.
+	size_t getNumVoxels() const;
+
+	/// \brief Writes one point per occupied voxel into 'out', ordered by voxel
+	/// so the result does not depend on the batch sizes or thread count.
+	void getPoints( std::vector<ofVec3d>& out ) const;
+
+	/// \brief Removes all the voxels.
+	void clear();
+
+	double getVoxelSize() const;
+	ofVoxelDownsampleMode getMode() const;
+	const ofVec3d& getOrigin() const;
+
+	/// \cond INTERNAL
+	struct Key {
+		long long x, y, z;
+		bool operator==( const Key& k ) const { return x == k.x && y == k.y && z == k.z; }
+		bool operator<( const Key& k ) const {
+			return x != k.x ? x < k.x : (y != k.y ? y < k.y : z < k.z);
+		}
+	};
+	struct KeyHash {
+		size_t operator()( const Key& k ) const;
+	};
+	// 'value' is relative to the voxel corner to keep precision far from the origin:
+	// the sum of the points in centroid mode, the nearest point otherwise.
+	struct Voxel {
+		ofVec3d value;
+		double distanceSquared;
+		size_t count;
+	};
+	/// \endcond
+
+private:
+	Key getKey( const ofVec3d& p ) const;
+	ofVec3d getCorner( const Key& k ) const;
+	void merge( Voxel& dst, const Voxel& src ) const;
+
+	double voxelSize;
+	ofVoxelDownsampleMode mode;
+	ofVec3d origin;
+	std::vector< std::unordered_map<Key, Voxel, KeyHash> > shards;
+};
+
+/// \brief Thins 'num' points to one point per voxel of size 'voxelSize'.
+///
+/// One shot version of ofVoxelDownsamplerd.
+void ofVoxelDownsample( const ofVec3d* points, size_t num, double voxelSize,
+					   std::vector<ofVec3d>& out, ofVoxelDownsampleMode mode = OF_VOXEL_CENTROID );